@@ -1,76 +1,682 @@
 #include "include/auction.h"
+#include "include/bidding.h"
+#include "include/flow.h"
 #include <iostream>
 #include <deque>
 #include <queue>
 #include <algorithm> 
 #include <random>
+#include <cfloat>
+#include <cstring>
+
+// The k best objects bidder does not hold, see scanBestObjects
+static int bestObjects(CSR* G, Bidder* A, Object* B, int bidder, int k, double min_value, vector<pair<float, Edge>>& best) {
+    return bestObjects(G, bidder, k, min_value, [&](Edge e, float& value) {
+        if (B[e.id - G->lVer].pq.IsEmpty() || A[bidder].matched.contains(e.id))
+            return false;
+        value = e.weight - B[e.id - G->lVer].pq.Top()->price;
+        return true;
+    }, best);
+}
+
+// Rebuilds the candidate cache of bidder from a full scan, see
+// cachedBestObjects. Returns the number of edges scanned.
+template <typename Row>
+static int scanCandidates(CSR* G, Object* B, Bidder& a, int bidder, int cache_size, double min_value) {
+    greater<pair<float, Edge>> comp;   // Min-heap on value
+    pair<float, Edge>* cache = a.cache;
+    int size = 0;
+    float bound = -FLT_MAX;
+    Row row(G, bidder);
+    Edge e;
+    int scanned = 0;
+    while (row.next(e)) {
+        if (G->weightSorted) {
+            if (e.weight < 0 || e.weight < min_value || (size == cache_size && e.weight <= cache[0].first)) {
+                bound = max(bound, e.weight);   // Bounds the value of every unscanned edge
+                break;
+            }
+        }
+        scanned++;
+        if (e.weight >= 0 && !B[e.id - G->lVer].pq.IsEmpty()) {
+            float value = e.weight - B[e.id - G->lVer].pq.Top()->price;
+            if (value < min_value)
+                continue;
+            if (size < cache_size) {
+                cache[size++] = make_pair(value, e);
+                push_heap(cache, cache + size, comp);
+            }
+            else if (cache[0].first < value) {
+                bound = max(bound, cache[0].first);
+                pop_heap(cache, cache + size, comp);
+                cache[size-1] = make_pair(value, e);
+                push_heap(cache, cache + size, comp);
+            }
+            else {
+                bound = max(bound, value);
+            }
+        }
+    }
+    sort_heap(cache, cache + size, comp);
+    a.cache_size = size;
+    a.cache_bound = bound;
+    return scanned;
+}
+
+// Same result as bestObjects, but first tries the bidder's cached candidates.
+// A full scan keeps the cache_size most valuable neighbors (held ones
+// included, so that objects lost later stay covered) and cache_bound, an
+// upper bound on the value of every neighbor left out. As long as no object
+// price has dropped since (price_drops is unchanged), values can only have
+// fallen, so the cache answers the query whenever its k-th best current
+// value is still at least cache_bound. Otherwise the neighbors are rescanned.
+static int cachedBestObjects(CSR* G, Bidder* A, Object* B, int bidder, int k, int cache_size, double min_value, long price_drops, vector<pair<float, Edge>>& best, bool& hit) {
+    greater<pair<float, Edge>> comp;   // Min-heap on value
+    Bidder& a = A[bidder];
+
+    hit = false;
+    if (a.cache_price_drops == price_drops) {
+        best.clear();
+        for (int c = 0; c < a.cache_size; c++) {
+            Edge e = a.cache[c].second;
+            if (a.matched.contains(e.id))
+                continue;
+            float value = e.weight - B[e.id - G->lVer].pq.Top()->price;
+            if (value >= min_value)
+                offerBest(best, k, value, e);
+        }
+        if (a.cache_bound < min_value || (best.size() == k && best.front().first >= a.cache_bound)) {
+            sort_heap(best.begin(), best.end(), comp);
+            hit = true;
+            return a.cache_size;
+        }
+    }
+
+    // Rebuild the cache from a full scan
+    int scanned = G->packed ? scanCandidates<PackedRow>(G, B, a, bidder, cache_size, min_value)
+                            : scanCandidates<PlainRow>(G, B, a, bidder, cache_size, min_value);
+    a.cache_price_drops = price_drops;
+
+    best.clear();
+    for (int c = 0; c < a.cache_size && best.size() < k; c++) {
+        if (!a.matched.contains(a.cache[c].second.id))
+            best.push_back(a.cache[c]);
+    }
+    return scanned;
+}
+
+// Copies the matched edges and the object prices out of the auction state.
+// An object without copies can never be bought and gets price FLT_MAX.
+static void collectOutput(CSR* G, Object* B, AuctionOutput& out) {
+    out.matching.clear();
+    out.prices.assign(G->rVer, FLT_MAX);
+    for (int i = G->lVer; i < G->nVer; i++) {
+        Object& o = B[i - G->lVer];
+        if (!o.pq.IsEmpty())
+            out.prices[i - G->lVer] = o.pq.Top()->price;
+        for (int j = 0; j < o.num_copies; j++) {
+            ObjectCopy& c = o.object_copies[j];
+            if (c.matched.id >= 0)
+                out.matching.push_back(MatchedEdge(c.matched.id, i, c.matched.weight, c.price));
+        }
+    }
+}
+
+template <typename Row>
+static double scanDualBound(CSR* G, Node* S, const vector<float>& prices) {
+    double bound = 0;
+    #pragma omp parallel reduction(+:bound)
+    {
+        greater<float> comp;   // Min-heap on value
+        vector<float> top;
+        #pragma omp for schedule(dynamic, 256) nowait
+        for (int i = 0; i < G->lVer; i++) {
+            if (S[i].b == 0)
+                continue;
+            top.clear();
+            Row row(G, i);
+            Edge e;
+            while (row.next(e)) {
+                float value = e.weight - max(0.0f, prices[e.id - G->lVer]);
+                if (e.weight < 0 || value <= 0)
+                    continue;
+                if (top.size() < S[i].b) {
+                    top.push_back(value);
+                    push_heap(top.begin(), top.end(), comp);
+                }
+                else if (top.front() < value) {
+                    pop_heap(top.begin(), top.end(), comp);
+                    top.back() = value;
+                    push_heap(top.begin(), top.end(), comp);
+                }
+            }
+            for (float v : top) {
+                bound += v;
+            }
+        }
+
+        #pragma omp for schedule(static) nowait
+        for (int o = 0; o < G->rVer; o++) {
+            if (S[G->lVer + o].b > 0)
+                bound += (double) S[G->lVer + o].b * max(0.0f, prices[o]);
+        }
+    }
+    return bound;
+}
+
+double matchingDualBound(CSR* G, Node* S, const vector<float>& prices) {
+    if (G->packed)
+        return scanDualBound<PackedRow>(G, S, prices);
+    return scanDualBound<PlainRow>(G, S, prices);
+}
+
+static double dualBound(CSR* G, Node* S, Object* B) {
+    vector<float> prices(G->rVer);
+    for (int o = 0; o < G->rVer; o++) {
+        prices[o] = B[o].pq.IsEmpty() ? FLT_MAX : B[o].pq.Top()->price;
+    }
+    return matchingDualBound(G, S, prices);
+}
+
+// Carves the bidders and objects, the object copies and priority queues,
+// the matched-object tables and the candidate caches out of arena, which is
+// sized for all of them up front. Objects are constructed serially, the
+// rest of the setup is independent per vertex and runs in parallel.
+static void initState(CSR* G, Node* S, int cache_slack, Arena& arena, Bidder*& A, Object*& B) {
+    long copies = 0, slots = 0, cache = 0;
+    for (int i = 0; i < G->lVer; i++) {
+        slots += MatchedSet::slotsFor(S[i].b);
+        if (cache_slack > 0)
+            cache += S[i].b + 1 + cache_slack;
+    }
+    for (int i = G->lVer; i < G->nVer; i++) {
+        copies += S[i].b;
+    }
+
+    size_t pad = 64;
+    size_t bytes = G->lVer * sizeof(Bidder) + G->rVer * sizeof(Object)
+                 + copies * (sizeof(ObjectCopy) + sizeof(ObjectCopy*))
+                 + slots * sizeof(MatchedSlot) + cache * sizeof(pair<float, Edge>)
+                 + (G->rVer + 5) * pad;
+    arena.reserve(bytes);
+
+    A = arena.allocate<Bidder>(G->lVer);
+    B = arena.allocate<Object>(G->rVer);
+    ObjectCopy* copy_pool = arena.allocate<ObjectCopy>(copies);
+    MatchedSlot* slot_pool = arena.allocate<MatchedSlot>(slots);
+    pair<float, Edge>* cache_pool = arena.allocate<pair<float, Edge>>(cache);
+
+    // The queues draw their heap arrays from the arena one after the other
+    long offset = 0;
+    for (int i = G->lVer; i < G->nVer; i++) {
+        Object* o = new (&B[i - G->lVer]) Object(&arena);
+        o->object_copies = copy_pool + offset;
+        o->num_copies = S[i].b;
+        o->pq.SetCapacity(S[i].b);
+        offset += S[i].b;
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (int i = G->lVer; i < G->nVer; i++) {
+        Object& o = B[i - G->lVer];
+        for (int j = 0; j < o.num_copies; j++) {
+            new (&o.object_copies[j]) ObjectCopy(0.0, i);
+            o.pq.Add(&o.object_copies[j]);   // Min adjustable priority queue of b(i) object copies
+        }
+    }
+
+    vector<long> slot_start(G->lVer + 1, 0), cache_start(G->lVer + 1, 0);
+    for (int i = 0; i < G->lVer; i++) {
+        slot_start[i+1] = slot_start[i] + MatchedSet::slotsFor(S[i].b);
+        cache_start[i+1] = cache_start[i] + (cache_slack > 0 ? S[i].b + 1 + cache_slack : 0);
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < G->lVer; i++) {
+        Bidder* a = new (&A[i]) Bidder();
+        a->matched.init(slot_pool + slot_start[i], slot_start[i+1] - slot_start[i]);
+        if (cache_slack > 0)
+            a->cache = cache_pool + cache_start[i];
+    }
+}
+
+// Starts every copy of each object at its warm price instead of 0. All
+// copies of an object get the same price, so the queues stay valid.
+static void warmStart(CSR* G, Object* B, const vector<float>& prices) {
+    #pragma omp parallel for schedule(static)
+    for (int o = 0; o < G->rVer; o++) {
+        float p = (prices[o] > 0 && prices[o] < FLT_MAX) ? prices[o] : 0;
+        for (int j = 0; j < B[o].num_copies; j++) {
+            B[o].object_copies[j].price = p;
+        }
+    }
+}
+
+// Prices near equilibrium are not enough to skip the bidding: a bid leaves
+// the bidder's copies epsilon below its comparison object, so at those
+// prices every bidder starting empty handed goes for another bidder's object
+// and the evictions cascade. Matches instead, as far as the objects allow,
+// each bidder to objects worth at least its b-th most valuable one minus
+// epsilon (a maximum b-matching of those edges, selling the copies priced
+// above 0 first). A bidder filled that way starts happy, and the first full
+// check of repairWarmStart queues the few that still miss an object; only
+// the bidders left with room are queued here. Every copy of an object still
+// has the same price, so the queues stay valid.
+static void seedWarmMatching(CSR* G, Node* S, Bidder* A, Object* B, double epsilon, BidderScheduler& I) {
+    int m = G->verPtr[G->lVer];
+    vector<char> allowed(m, 0);
+    #pragma omp parallel
+    {
+        vector<float> values;
+        #pragma omp for schedule(dynamic, 1024)
+        for (int i = 0; i < G->lVer; i++) {
+            values.clear();
+            float scale = 0;
+            forEachEdge(G, i, [&](Edge e) {
+                if (e.weight < 0 || B[e.id - G->lVer].pq.IsEmpty())
+                    return;
+                float price = B[e.id - G->lVer].pq.Top()->price;
+                values.push_back(e.weight - price);
+                scale = max(scale, max(e.weight, price));
+            });
+            if (S[i].b == 0 || values.empty())
+                continue;
+
+            // Any b objects worth at least the b-th best value minus epsilon
+            // leave nothing outside worth more than epsilon above the least
+            // of them. Leave room for rounding, as repairWarmStart does.
+            int b = min<int>(S[i].b, values.size());
+            nth_element(values.begin(), values.begin() + b - 1, values.end(), greater<float>());
+            double threshold = max(0.0, values[b-1] - epsilon - 4 * FLT_EPSILON * scale);
+            int j = G->verPtr[i];
+            forEachEdge(G, i, [&](Edge e) {
+                allowed[j++] = e.weight >= 0 && !B[e.id - G->lVer].pq.IsEmpty()
+                               && e.weight - B[e.id - G->lVer].pq.Top()->price >= threshold;
+            });
+        }
+    }
+
+    // Sell the copies priced above 0 first, as they must all be sold at the
+    // end; augmenting paths never unsell a copy, so the second pass over
+    // every allowed edge keeps them sold
+    FlowNetwork net(G, S, &allowed);
+    vector<char> priced(m);
+    #pragma omp parallel for schedule(static)
+    for (int j = 0; j < m; j++) {
+        priced[j] = allowed[j] && B[net.col[j]].pq.Top()->price > 0;
+    }
+    FlowNetwork first(G, S, &priced);
+    first.greedy();
+    first.maxFlow();
+    for (int j = 0; j < m; j++) {
+        if (first.flow[j]) {
+            net.flow[j] = 1;
+            net.outL[first.rowOf[j]]++;
+            net.inR[net.col[j]]++;
+        }
+    }
+    net.greedy();
+    net.maxFlow();
+
+    vector<int> sold(G->rVer, 0);
+    for (int i = 0; i < G->lVer; i++) {
+        int j = G->verPtr[i];
+        forEachEdge(G, i, [&](Edge e) {
+            if (!net.flow[j++])
+                return;
+            int o = e.id - G->lVer;
+            ObjectCopy* c = &B[o].object_copies[sold[o]++];
+            c->matched = e;
+            c->matched.id = i;
+            A[i].matched.insert(e.id, c);
+        });
+        if (A[i].matched.size() < S[i].b)
+            I.push(i, S[i].b - A[i].matched.size());
+        else
+            A[i].is_strongly_eps_happy = true;
+    }
+}
+
+// Bookkeeping of repairWarmStart. Only a price drop can make a happy bidder
+// want another object, so after a first full check only the bidders
+// adjacent to objects that got cheaper since the last check are examined.
+struct WarmRepair {
+    vector<char> cheaper;           // Objects whose lowest price may have dropped
+    vector<int> colPtr, colInd;     // Bidders adjacent to each object, built by the first check
+};
+
+// A warm started b-matching auction can empty its queue in a state a cold
+// start never reaches: copies nobody bought still priced above 0, and happy
+// bidders whose neighbors got cheaper than the prices they bid against.
+// Drops the prices of unmatched copies to 0 and queues again every bidder
+// that, at the current prices, sees an object it does not hold worth more
+// than its least valuable one plus epsilon (or at least epsilon while it has
+// room). A bid leaves the held copies exactly epsilon below the comparison
+// object only up to float rounding, so excesses within rounding of the
+// values involved don't count; requeueing for them would only rebid the
+// same prices forever. Returns true if bidders were queued; once it finds
+// none the state is eps-complementary slack, as after a cold start.
+static bool repairWarmStart(CSR* G, Node* S, Bidder* A, Object* B, BidderScheduler& I, double epsilon, long& price_drops, WarmRepair& R) {
+    bool lowered = false;
+    #pragma omp parallel for schedule(static) reduction(||:lowered)
+    for (int o = 0; o < G->rVer; o++) {
+        for (int j = 0; j < B[o].num_copies; j++) {
+            ObjectCopy& c = B[o].object_copies[j];
+            if (c.matched.id < 0 && c.price > 0) {
+                c.price = 0;
+                B[o].pq.NoteChangedPriority(&c);
+                R.cheaper[o] = 1;
+                lowered = true;
+            }
+        }
+    }
+    if (lowered)
+        price_drops++;
+
+    // Bidders to check: all of them the first time, then the neighbors of
+    // the objects that got cheaper
+    vector<char> check(G->lVer, 0);
+    if (R.colPtr.empty()) {
+        R.colPtr.assign(G->rVer + 1, 0);
+        for (int i = 0; i < G->lVer; i++) {
+            forEachEdge(G, i, [&](Edge e) { R.colPtr[e.id - G->lVer + 1]++; });
+        }
+        for (int o = 0; o < G->rVer; o++) {
+            R.colPtr[o+1] += R.colPtr[o];
+        }
+        R.colInd.resize(R.colPtr[G->rVer]);
+        vector<int> next(R.colPtr.begin(), R.colPtr.end() - 1);
+        for (int i = 0; i < G->lVer; i++) {
+            forEachEdge(G, i, [&](Edge e) { R.colInd[next[e.id - G->lVer]++] = i; });
+        }
+        check.assign(G->lVer, 1);
+    }
+    else {
+        for (int o = 0; o < G->rVer; o++) {
+            if (R.cheaper[o]) {
+                for (int k = R.colPtr[o]; k < R.colPtr[o+1]; k++) {
+                    check[R.colInd[k]] = 1;
+                }
+            }
+        }
+    }
+    R.cheaper.assign(G->rVer, 0);
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int i = 0; i < G->lVer; i++) {
+        if (!check[i])
+            continue;
+        float min_held = FLT_MAX;
+        float scale = 0;    // Magnitude of the held weights and prices
+        for (const auto& [j, c] : A[i].matched) {
+            min_held = min(min_held, c->matched.weight - c->price);
+            scale = max(scale, max(fabs(c->matched.weight), fabs(c->price)));
+        }
+        bool saturated = A[i].matched.size() >= S[i].b;
+        double bound = saturated ? min_held + epsilon : epsilon;
+        check[i] = 0;
+        forEachEdge(G, i, [&](Edge e) {
+            if (check[i] || e.weight < 0 || B[e.id - G->lVer].pq.IsEmpty() || A[i].matched.contains(e.id))
+                return;
+            float price = B[e.id - G->lVer].pq.Top()->price;
+            float value = e.weight - price;
+            double rounding = saturated ? 4 * FLT_EPSILON * max(scale, max(fabs(e.weight), fabs(price))) : 0;
+            if (value > bound + rounding || (!saturated && value >= bound))
+                check[i] = 1;
+        });
+    }
+
+    bool queued = false;
+    for (int i = 0; i < G->lVer; i++) {
+        if (check[i]) {
+            A[i].is_strongly_eps_happy = false;
+            A[i].permanent = false;
+            queued |= I.push(i, S[i].b - A[i].matched.size());
+        }
+    }
+    return queued;
+}
+
+// Copies the state between two bids into snap
+static void captureState(CSR* G, Node* S, Bidder* A, Object* B, const BidderScheduler& I, long price_drops, int algorithm, double epsilon, AuctionSnapshot& snap) {
+    CheckpointHeader& h = snap.header;
+    memcpy(h.magic, checkpointMagic, sizeof(h.magic));
+    h.algorithm = algorithm;
+    h.reserved = 0;
+    h.numVertices = G->nVer;
+    h.numBidders = G->lVer;
+    h.priceDrops = price_drops;
+    h.bHash = hashBValues(S, G->nVer);
+    h.epsilon = epsilon;
+
+    snap.copies.clear();
+    for (int o = 0; o < G->rVer; o++) {
+        for (int j = 0; j < B[o].num_copies; j++) {
+            ObjectCopy& c = B[o].object_copies[j];
+            snap.copies.push_back({c.price, c.matched.id, c.matched.weight, c.heap_index});
+        }
+    }
+    h.numCopies = snap.copies.size();
 
-AlgResult bMatchingAuction(CSR* G, Node* S, double epsilon, bool verbose) {
+    snap.flags.resize(G->lVer);
+    for (int i = 0; i < G->lVer; i++) {
+        snap.flags[i] = (A[i].is_strongly_eps_happy ? BIDDER_HAPPY : 0) | (A[i].permanent ? BIDDER_PERMANENT : 0);
+    }
+    vector<int> queue = I.contents();
+    snap.queue.assign(queue.begin(), queue.end());
+    h.numQueued = snap.queue.size();
+}
+
+// Loads the snapshot in filename into the freshly initialized state. Returns
+// false, leaving the state untouched, if there is no such snapshot or it
+// belongs to another instance.
+static bool resumeState(CSR* G, Node* S, Bidder* A, Object* B, BidderScheduler& I, long& price_drops, int algorithm, double epsilon, const char* filename) {
+    if (filename == NULL)
+        return false;
+    AuctionSnapshot snap;
+    if (!readCheckpoint(filename, snap)) {
+        cerr << "Warning: can't read checkpoint " << filename << ", starting from scratch" << endl;
+        return false;
+    }
+    long copies = 0;
+    for (int o = 0; o < G->rVer; o++) {
+        copies += B[o].num_copies;
+    }
+    const CheckpointHeader& h = snap.header;
+    if (h.algorithm != algorithm || h.numVertices != G->nVer || h.numBidders != G->lVer || h.numCopies != copies
+            || h.bHash != hashBValues(S, G->nVer) || h.epsilon != epsilon) {
+        cerr << "Warning: checkpoint " << filename << " belongs to another instance, starting from scratch" << endl;
+        return false;
+    }
+
+    // Every queue position must be taken once and every owner be a bidder
+    long k = 0;
+    vector<char> taken;
+    for (int o = 0; o < G->rVer; o++) {
+        int n = B[o].num_copies;
+        taken.assign(n, 0);
+        for (int j = 0; j < n; j++, k++) {
+            int pos = snap.copies[k].heapIndex;
+            int owner = snap.copies[k].bidder;
+            if (pos < 0 || pos >= n || taken[pos]++ || owner >= G->lVer) {
+                cerr << "Warning: checkpoint " << filename << " is corrupt, starting from scratch" << endl;
+                return false;
+            }
+        }
+    }
+    for (int bidder : snap.queue) {
+        if (bidder < 0 || bidder >= G->lVer) {
+            cerr << "Warning: checkpoint " << filename << " is corrupt, starting from scratch" << endl;
+            return false;
+        }
+    }
+
+    // Adding the copies in heap order rebuilds each queue exactly
+    k = 0;
+    vector<ObjectCopy*> heap;
+    for (int o = 0; o < G->rVer; o++) {
+        int n = B[o].num_copies;
+        heap.assign(n, NULL);
+        for (int j = 0; j < n; j++, k++) {
+            ObjectCopy& c = B[o].object_copies[j];
+            c.price = snap.copies[k].price;
+            c.matched = Edge(snap.copies[k].bidder, snap.copies[k].weight);
+            heap[snap.copies[k].heapIndex] = &c;
+            if (c.matched.id >= 0)
+                A[c.matched.id].matched.insert(G->lVer + o, &c);
+        }
+        B[o].pq.Clear();
+        for (ObjectCopy* c : heap) {
+            B[o].pq.Add(c);
+        }
+    }
+    for (int i = 0; i < G->lVer; i++) {
+        A[i].is_strongly_eps_happy = snap.flags[i] & BIDDER_HAPPY;
+        A[i].permanent = snap.flags[i] & BIDDER_PERMANENT;
+    }
+    for (int bidder : snap.queue) {
+        I.push(bidder, S[bidder].b - A[bidder].matched.size());
+    }
+    price_drops = h.priceDrops;
+    cout << "Resumed from " << filename << " with " << snap.queue.size() << " bidders queued" << endl;
+    return true;
+}
+
+AlgResult bMatchingAuction(CSR* G, Node* S, double epsilon, bool verbose, const AuctionOptions& aopts) {
     if (verbose) 
         std::cout << "Running b-Matching Auction" << endl;
 
     double start = omp_get_wtime();
+    if (aopts.prof) aopts.prof->begin("Auction Init");
 
     // Initialize the auxilliary data structures
-    Bidder* A = new Bidder[G->lVer];    // Array of bidders
-    Object* B = new Object[G->rVer];    // Array of objects
-
-    for (int i = G->rVer; i < G->nVer; i++) {
-        B[i - G->lVer].object_copies.reserve(S[i].b);
-        B[i - G->lVer].pq.SetCapacity(S[i].b);
-        for (int j = 0; j < S[i].b; j++) {
-            B[i - G->lVer].object_copies.push_back(ObjectCopy(0.0, i));
-            B[i - G->lVer].pq.Add(&B[i - G->lVer].object_copies.back());   // Min adjustable priority queue of b(i) object copies
-        }
-        if (verbose) {
-            std::cout << "B[" << i << "].pq: ";
-            vector<ObjectCopy*> v = *B[i - G->lVer].pq.Raw();
-            for (auto it = v.begin(); it != v.end(); it++) {
-                std::cout << (*it)->price << ", " << (*it)->heap_index << " | ";
-            }
-            std::cout << endl;
+    Arena local_arena;
+    Arena* arena = aopts.arena ? aopts.arena : &local_arena;
+    Bidder* A;  // Array of bidders
+    Object* B;  // Array of objects
+    initState(G, S, aopts.cache_slack, *arena, A, B);
+    STATS_DO(AuctionStats stats; stats.bid_rounds.assign(G->lVer, 0);)
+
+    for (int i = G->lVer; verbose && i < G->nVer; i++) {
+        std::cout << "B[" << i << "].pq: ";
+        auto& v = *B[i - G->lVer].pq.Raw();
+        for (auto it = v.begin(); it != v.end(); it++) {
+            std::cout << (*it)->price << ", " << (*it)->heap_index << " | ";
         }
+        std::cout << endl;
     }
     
-    queue<int> I;   //Unsaturated bidders
-    for (int i = 0; i < G->lVer; i++) {
-        //I.push_back(i);
-        I.push(i);
+    BidderScheduler I(aopts.schedule, G->lVer);   //Unsaturated bidders
+    long price_drops = 0;   // Invalidates every bidder's candidate cache
+    bool warm = aopts.warm_prices != NULL;     // Also when resuming a warm started run
+    WarmRepair repair;
+    if (warm)
+        repair.cheaper.assign(G->rVer, 0);
+    if (!resumeState(G, S, A, B, I, price_drops, 1, epsilon, aopts.resume_file)) {
+        if (warm) {
+            warmStart(G, B, *aopts.warm_prices);
+            seedWarmMatching(G, S, A, B, epsilon, I);
+        }
+        else {
+            for (int i = 0; i < G->lVer; i++) {
+                I.push(i, S[i].b);
+            }
+        }
     }
+    STATS_ADD(stats, queue_pushes, I.size());
+    Checkpointer* ckpt = aopts.checkpoint_file ? new Checkpointer(aopts.checkpoint_file, aopts.checkpoint_interval) : NULL;
+    long steps = 0;
     //shuffle(I.begin(), I.end(), default_random_engine(time(0)));
 
+    // Anytime state: the weight of the current matching is kept up to date
+    // and the heaviest one seen is saved whenever the clock is checked, at
+    // most a tenth of the time, so the auction can stop at any point
+    bool limited = aopts.deadline > 0 || aopts.bid_budget > 0;
+    bool interrupted = false;
+    long rounds = 0;
+    long num_copies = 0;
+    double current_weight = 0;
+    for (int o = 0; o < G->rVer; o++) {
+        num_copies += B[o].num_copies;
+    }
+    ObjectCopy* all_copies = (G->rVer > 0) ? B[0].object_copies : NULL;    // Copies are contiguous in the arena
+    if (limited || aopts.progress) {
+        for (long c = 0; c < num_copies; c++) {
+            current_weight += all_copies[c].matched.weight;
+        }
+    }
+    // A resumed or warm started run begins with a matching, which is the
+    // heaviest seen so far
+    vector<Edge> best_matching;
+    if (limited) {
+        best_matching.resize(num_copies);
+        for (long c = 0; c < num_copies; c++) {
+            best_matching[c] = all_copies[c].matched;
+        }
+    }
+    double best_weight = current_weight;
+    double next_save = 0;
+    long other_rounds = aopts.shared_rounds ? aopts.shared_rounds->load() : 0;   // Rounds of the other solves sharing the budget
+    long synced_rounds = 0;
+
     double time_init = omp_get_wtime();
-    while(!I.empty()){
-        int bidder = I.front();
+    double next_progress = time_init + aopts.progress_interval;
+    if (aopts.prof) {
+        aopts.prof->end();
+        aopts.prof->begin("Bidding");
+    }
+    vector<pair<float, Edge>> best_objs;
+    vector<pair<int, ObjectCopy*>> release;
+    while(!I.empty() || (warm && repairWarmStart(G, S, A, B, I, epsilon, price_drops, repair))){
+        if (aopts.bid_budget > 0 && other_rounds + rounds >= aopts.bid_budget) {
+            interrupted = true;
+            break;
+        }
+        int bidder = I.pop();
 
         if (!A[bidder].is_strongly_eps_happy) {
+            STATS_DO(stats.bid_rounds[bidder]++;)
+            rounds++;
+
+            // Held copies worth less than the comparison object even for
+            // free are given up before bidding and go back on sale at 0, as
+            // unmatched copies are priced after a cold start; the bidder then
+            // looks for as many more objects. Only warm prices get this far
+            // apart, and each pass gives up at least one copy.
+            int k;
+            do {
+                k = S[bidder].b + 1 - A[bidder].matched.size();
+                [[maybe_unused]] int scanned;
+                if (aopts.cache_slack > 0) {
+                    bool hit;
+                    scanned = cachedBestObjects(G, A, B, bidder, k, S[bidder].b + 1 + aopts.cache_slack, epsilon, price_drops, best_objs, hit);
+                    STATS_DO(if (hit) stats.cache_hits++; else stats.cache_misses++;)
+                }
+                else {
+                    scanned = bestObjects(G, A, B, bidder, k, epsilon, best_objs);
+                }
+                STATS_ADD(stats, edges_scanned, scanned);
 
-            vector<pair<float, Edge>> objs_to_look_at;
-            for (int i = G->verPtr[bidder]; i < G->verPtr[bidder+1]; i++) {
-                //::std::cout << "Starting Auction Loop" << endl;
-                //if (G->verInd[i].weight >= 0 && !A[bidder].matched.contains(G->verInd[i].id)) {
-                if (G->verInd[i].weight >= 0 && A[bidder].matched.find(G->verInd[i].id) == A[bidder].matched.end()) {
-                    //std::std::cout << "Starting Auction Loop2" << endl;
-                    Edge e = G->verInd[i];
-                    float value = e.weight - B[e.id - G->lVer].pq.Top()->price;
-                    if (value >= epsilon) {
-                        objs_to_look_at.push_back(make_pair(value, e));
-                    }
+                release.clear();
+                float comparison_value = (best_objs.size() < k) ? epsilon : best_objs.back().first;
+                for (const auto& [j, c] : A[bidder].matched) {
+                    if (warm && bidIncrement(c->matched.weight, comparison_value, epsilon) < 0)
+                        release.push_back(make_pair(j, c));
                 }
-            }
+                for (auto& [j, c] : release) {
+                    current_weight -= c->matched.weight;
+                    c->matched = Edge(-1, 0.0);
+                    c->price = 0;
+                    B[c->object_id - G->lVer].pq.NoteChangedPriority(c);
+                    repair.cheaper[c->object_id - G->lVer] = 1;
+                    price_drops++;
+                    A[bidder].matched.erase(j);
+                }
+            } while (!release.empty());
 
-            pair<float, Edge> comparison_obj;
-            vector<pair<float, Edge>> best_objs = kBestObject(objs_to_look_at, S[bidder].b + 1 - A[bidder].matched.size());
-            if (best_objs.size() < S[bidder].b + 1 - A[bidder].matched.size()) {
-                comparison_obj = make_pair(epsilon, Edge(-1, 0));
-                A[bidder].permanent = true;
-            }
-            else {
-                comparison_obj = best_objs.back();
-                best_objs.pop_back();
-            }
+            pair<float, Edge> comparison_obj = takeComparison(best_objs, k, epsilon, A[bidder].permanent);
 
-            // print the elements of objs_to_look_at
+            // print the elements of best_objs
             if (verbose) {
                 std::cout << "Bidder " << bidder << " (b: " << S[bidder].b << ") " << "is matched to: (";
                 for (const auto& [key, value] : A[bidder].matched ) {
@@ -86,115 +692,202 @@ AlgResult bMatchingAuction(CSR* G, Node* S, double epsilon, bool verbose) {
             }
 
             for(const auto& [j, c] : A[bidder].matched) {
-                float bid = c->matched.weight - c->price - comparison_obj.first + epsilon;
+                float bid = bidIncrement(c->matched.weight - c->price, comparison_obj.first, epsilon);
                 c->price += bid;
+                if (bid < 0) {
+                    price_drops++;
+                    if (warm)
+                        repair.cheaper[c->object_id - G->lVer] = 1;
+                }
                 B[c->object_id - G->lVer].pq.NoteChangedPriority(c);
+                STATS_INC(stats, rebids);
             } 
 
             for (auto& obj : best_objs) {
                 Edge e = obj.second;
                 int obj_id = e.id;
-                float bid = obj.first - comparison_obj.first + epsilon;
+                float bid = bidIncrement(obj.first, comparison_obj.first, epsilon);
 
                 ObjectCopy* c = B[obj_id - G->lVer].pq.Top();
                 int old_bidder = c->matched.id;
+                current_weight += e.weight - c->matched.weight;
                 c->price += bid;
                 c->matched = {bidder, e.weight};
                 B[c->object_id - G->lVer].pq.NoteChangedPriority(c);
-                A[bidder].matched.insert({obj_id, c});
+                A[bidder].matched.insert(obj_id, c);
+                STATS_INC(stats, bids);
 
                 // Remove matched edge from old bidder
                 if (old_bidder >= 0) {
                     A[old_bidder].matched.erase(obj_id);
+                    STATS_INC(stats, evictions);
                     if (!A[old_bidder].permanent) {
                         A[old_bidder].is_strongly_eps_happy = false;
-                        //I.push_back(old_bidder);
-                        I.push(old_bidder);
+                        [[maybe_unused]] bool queued = I.push(old_bidder, S[old_bidder].b - A[old_bidder].matched.size());
+                        STATS_DO(if (queued) stats.queue_pushes++;)
                     }
                 }
             }
-
             A[bidder].is_strongly_eps_happy = true;
         }
-        //I.pop_front();
-        I.pop();
+        else {
+            STATS_INC(stats, stale_pops);
+        }
+
+        // Snapshots and anytime checks between two bids, reading the clock
+        // every 1024 bidders
+        if ((++steps & 1023) != 0)
+            continue;
+        if (aopts.shared_rounds) {
+            other_rounds = aopts.shared_rounds->fetch_add(rounds - synced_rounds) - synced_rounds;
+            synced_rounds = rounds;
+        }
+        AuctionSnapshot* snap;
+        if (ckpt && ckpt->due(snap)) {
+            captureState(G, S, A, B, I, price_drops, 1, epsilon, *snap);
+            ckpt->submit(snap);
+        }
+        if (limited || aopts.progress) {
+            double now = omp_get_wtime();
+            if (limited && current_weight > best_weight && now >= next_save) {
+                best_matching.resize(num_copies);
+                for (long c = 0; c < num_copies; c++) {
+                    best_matching[c] = all_copies[c].matched;
+                }
+                best_weight = current_weight;
+                double done = omp_get_wtime();
+                next_save = done + 9 * (done - now);
+            }
+            if (aopts.progress && now >= next_progress) {
+                AuctionProgress p = {now - time_init, rounds, current_weight, dualBound(G, S, B), I.size()};
+                aopts.progress(p);
+                next_progress = omp_get_wtime() + aopts.progress_interval;
+            }
+            if (aopts.deadline > 0 && now - time_init >= aopts.deadline) {
+                interrupted = true;
+                break;
+            }
+        }
+    }
+    if (aopts.shared_rounds)
+        aopts.shared_rounds->fetch_add(rounds - synced_rounds);
+    if (ckpt) {
+        ckpt->finish();
+        if (verbose)
+            cout << "Checkpoints written: " << ckpt->written() << endl;
+        delete ckpt;
+    }
+
+    // Fall back to the saved matching if the current one is lighter
+    if (interrupted && best_weight > current_weight) {
+        for (long c = 0; c < num_copies; c++) {
+            all_copies[c].matched = best_matching[c];
+        }
     }
 
     double end =  omp_get_wtime();
+    if (aopts.prof) {
+        aopts.prof->end();
+        aopts.prof->begin("Weight Sum");
+    }
 
-    double weight;
-    for (int i = G->rVer; i < G->nVer; i++) {
-        for (int j = 0; j < S[i].b; j++) {
+    double weight = 0;
+    for (int i = G->lVer; i < G->nVer; i++) {
+        for (int j = 0; j < B[i - G->lVer].num_copies; j++) {
             weight += B[i - G->lVer].object_copies[j].matched.weight;
         }
     }
+    if (aopts.prof) aopts.prof->end();
+
+    if (aopts.out)
+        collectOutput(G, B, *aopts.out);
+
+    STATS_DO(for (int i = 0; i < G->rVer; i++) stats.sift_steps += B[i].pq.SiftSteps();)
 
-    delete [] A;
-    delete [] B;
-    //return AlgResult(end - start, time_init - start, weight);
-    return AlgResult(end - start, 0, weight);
+    AlgResult res(end - start, time_init - start, weight);
+    if (interrupted) {
+        res.interrupted = true;
+        res.bound = dualBound(G, S, B);
+    }
+    STATS_DO(res.stats = stats;)
+    return res;
 }
 
-AlgResult bFactorAuction(CSR* G, Node* S, double epsilon, bool verbose) {
+AlgResult bFactorAuction(CSR* G, Node* S, double epsilon, bool verbose, const AuctionOptions& aopts) {
     if (verbose) 
         std::cout << "Running b-Factor Auction" << endl;
 
     double start = omp_get_wtime();
+    if (aopts.prof) aopts.prof->begin("Auction Init");
 
     // Initialize the auxilliary data structures
-    Bidder* A = new Bidder[G->lVer];    // Array of bidders
-    Object* B = new Object[G->rVer];    // Array of objects
-
-    //vector<Bidder> A;
-    //vector<Object> B;
-    //A.reserve(G->lVer);
-    //B.reserve(G->rVer);
-
-    for (int i = G->rVer; i < G->nVer; i++) {
-        B[i - G->lVer].object_copies.reserve(S[i].b);
-        B[i - G->lVer].pq.SetCapacity(S[i].b);
-        for (int j = 0; j < S[i].b; j++) {
-            B[i - G->lVer].object_copies.push_back(ObjectCopy(0.0, i));
-            B[i - G->lVer].pq.Add(&B[i - G->lVer].object_copies.back());   // Min adjustable priority queue of b(i) object copies
-        }
-        if (verbose) {
-            std::cout << "B[" << i << "].pq: ";
-            vector<ObjectCopy*> v = *B[i - G->lVer].pq.Raw();
-            for (auto it = v.begin(); it != v.end(); it++) {
-                std::cout << (*it)->price << ", " << (*it)->heap_index << " | ";
-            }
-            std::cout << endl;
+    Arena local_arena;
+    Arena* arena = aopts.arena ? aopts.arena : &local_arena;
+    Bidder* A;  // Array of bidders
+    Object* B;  // Array of objects
+    initState(G, S, aopts.cache_slack, *arena, A, B);
+    STATS_DO(AuctionStats stats; stats.bid_rounds.assign(G->lVer, 0);)
+
+    for (int i = G->lVer; verbose && i < G->nVer; i++) {
+        std::cout << "B[" << i << "].pq: ";
+        auto& v = *B[i - G->lVer].pq.Raw();
+        for (auto it = v.begin(); it != v.end(); it++) {
+            std::cout << (*it)->price << ", " << (*it)->heap_index << " | ";
         }
+        std::cout << endl;
     }
     
-    deque<int> I;   //Unsaturated bidders
-    for (int i = 0; i < G->lVer; i++) {
-        I.push_back(i);
+    BidderScheduler I(aopts.schedule, G->lVer);   //Unsaturated bidders
+    long price_drops = 0;   // Invalidates every bidder's candidate cache
+    if (!resumeState(G, S, A, B, I, price_drops, 0, epsilon, aopts.resume_file)) {
+        if (aopts.warm_prices)
+            warmStart(G, B, *aopts.warm_prices);    // Every copy ends up matched, so any prices are safe
+        for (int i = 0; i < G->lVer; i++) {
+            I.push(i, S[i].b);
+        }
     }
+    STATS_ADD(stats, queue_pushes, I.size());
+    Checkpointer* ckpt = aopts.checkpoint_file ? new Checkpointer(aopts.checkpoint_file, aopts.checkpoint_interval) : NULL;
+    long steps = 0;
     //shuffle(I.begin(), I.end(), default_random_engine(time(0)));
 
     double time_init = omp_get_wtime();
+    if (aopts.prof) {
+        aopts.prof->end();
+        aopts.prof->begin("Bidding");
+    }
 
+    vector<pair<float, Edge>> best_objs;
     while(!I.empty()){
-        int bidder = I.front();
+        int bidder = I.pop();
         
         if (!A[bidder].is_strongly_eps_happy) {
-
-            vector<pair<float, Edge>> objs_to_look_at;
-            for (int i = G->verPtr[bidder]; i < G->verPtr[bidder+1]; i++) {
-                //if (G->verInd[i].weight >= 0 && !A[bidder].matched.contains(G->verInd[i].id)) {
-                if (G->verInd[i].weight >= 0 && A[bidder].matched.find(G->verInd[i].id) == A[bidder].matched.end()) {
-                    float value = G->verInd[i].weight - B[G->verInd[i].id - G->lVer].pq.Top()->price;
-                    objs_to_look_at.push_back(make_pair(value, G->verInd[i]));
-                }
+            STATS_DO(stats.bid_rounds[bidder]++;)
+
+            // Get the k most valuable neighbors
+            int k = S[bidder].b + 1 - A[bidder].matched.size();
+            [[maybe_unused]] int scanned;
+            if (aopts.cache_slack > 0) {
+                bool hit;
+                scanned = cachedBestObjects(G, A, B, bidder, k, S[bidder].b + 1 + aopts.cache_slack, -FLT_MAX, price_drops, best_objs, hit);
+                STATS_DO(if (hit) stats.cache_hits++; else stats.cache_misses++;)
+            }
+            else {
+                scanned = bestObjects(G, A, B, bidder, k, -FLT_MAX, best_objs);
+            }
+            STATS_ADD(stats, edges_scanned, scanned);
+            // With no spare neighbor left the bidder has to take every one it
+            // has, bidding as if the least valuable were its alternative
+            pair<float, Edge> comparison_obj;
+            if (best_objs.size() < k) {
+                comparison_obj = best_objs.empty() ? make_pair(0.0f, Edge()) : best_objs.back();
+            }
+            else {
+                comparison_obj = best_objs.back();
+                best_objs.pop_back();
             }
 
-            // Get the k largest elements from objs_to_look_at
-            vector<pair<float, Edge>> best_objs = kBestObject(objs_to_look_at, S[bidder].b + 1 - A[bidder].matched.size());
-            pair<float, Edge> comparison_obj = best_objs.back();
-            best_objs.pop_back();
-
-            // print the elements of objs_to_look_at
+            // print the elements of best_objs
             if (verbose) {
                 std::cout << "Bidder " << bidder << " (b: " << S[bidder].b << ") " << "is matched to: (";
                 for (const auto& [key, value] : A[bidder].matched ) {
@@ -210,44 +903,70 @@ AlgResult bFactorAuction(CSR* G, Node* S, double epsilon, bool verbose) {
             }
 
             for(const auto& [j, c] : A[bidder].matched) {
-                float bid = c->matched.weight - c->price - comparison_obj.first + epsilon;
+                float bid = bidIncrement(c->matched.weight - c->price, comparison_obj.first, epsilon);
                 c->price += bid;
+                if (bid < 0)
+                    price_drops++;
                 B[c->object_id - G->lVer].pq.NoteChangedPriority(c);
+                STATS_INC(stats, rebids);
             } 
 
             for (auto& obj : best_objs) {
                 Edge e = obj.second;
                 int obj_id = e.id;
-                float bid = obj.first - comparison_obj.first + epsilon;
+                float bid = bidIncrement(obj.first, comparison_obj.first, epsilon);
 
                 ObjectCopy* c = B[obj_id - G->lVer].pq.Top();
                 int old_bidder = c->matched.id;
                 c->price += bid;
                 c->matched = {bidder, e.weight};
                 B[c->object_id - G->lVer].pq.NoteChangedPriority(c);
-                A[bidder].matched.insert({obj_id, c});
+                A[bidder].matched.insert(obj_id, c);
+                STATS_INC(stats, bids);
 
                 // Remove matched edge from old bidder
                 if (old_bidder >= 0) {
                     A[old_bidder].matched.erase(obj_id);
+                    STATS_INC(stats, evictions);
                     A[old_bidder].is_strongly_eps_happy = false;
-                    I.push_back(old_bidder);
+                    [[maybe_unused]] bool queued = I.push(old_bidder, S[old_bidder].b - A[old_bidder].matched.size());
+                    STATS_DO(if (queued) stats.queue_pushes++;)
                 }
             }
 
             A[bidder].is_strongly_eps_happy = true;
         }
-        I.pop_front();
+        else {
+            STATS_INC(stats, stale_pops);
+        }
+
+        // Snapshot between two bids, checking the clock every 1024 bidders
+        AuctionSnapshot* snap;
+        if (ckpt && (++steps & 1023) == 0 && ckpt->due(snap)) {
+            captureState(G, S, A, B, I, price_drops, 0, epsilon, *snap);
+            ckpt->submit(snap);
+        }
+    }
+    if (ckpt) {
+        ckpt->finish();
+        if (verbose)
+            cout << "Checkpoints written: " << ckpt->written() << endl;
+        delete ckpt;
     }
 
     double end =  omp_get_wtime();
+    if (aopts.prof) {
+        aopts.prof->end();
+        aopts.prof->begin("Weight Sum");
+    }
 
-    double weight;
-    for (int i = G->rVer; i < G->nVer; i++) {
-        for (int j = 0; j < S[i].b; j++) {
+    double weight = 0;
+    for (int i = G->lVer; i < G->nVer; i++) {
+        for (int j = 0; j < B[i - G->lVer].num_copies; j++) {
             weight += B[i - G->lVer].object_copies[j].matched.weight;
         }
     }
+    if (aopts.prof) aopts.prof->end();
 
     /*
     std::cout << "\e[1mAuction (ε = " << epsilon << ")\e[0m" << endl;
@@ -256,9 +975,28 @@ AlgResult bFactorAuction(CSR* G, Node* S, double epsilon, bool verbose) {
     std::cout << "Running Time: " << end - start << endl << endl;
     */
 
-    delete [] A;
-    delete [] B;
-    return AlgResult(end - start, time_init - start, weight);
+    if (aopts.out)
+        collectOutput(G, B, *aopts.out);
+
+    STATS_DO(for (int i = 0; i < G->rVer; i++) stats.sift_steps += B[i].pq.SiftSteps();)
+
+    AlgResult res(end - start, time_init - start, weight);
+    STATS_DO(res.stats = stats;)
+    return res;
+}
+
+Auction::Auction(CSR* G, Node* S, double epsilon) : G(G), S(S), epsilon(epsilon) { }
+
+AlgResult Auction::bMatching(bool verbose) {
+    AuctionOptions aopts;
+    aopts.out = &output;
+    return bMatchingAuction(G, S, epsilon, verbose, aopts);
+}
+
+AlgResult Auction::bFactor(bool verbose) {
+    AuctionOptions aopts;
+    aopts.out = &output;
+    return bFactorAuction(G, S, epsilon, verbose, aopts);
 }
 
 // Function to get k best objects in a given array
@@ -0,0 +1,64 @@
+#include "include/batch.h"
+#include "include/bvalues.h"
+#include <cstring>
+using namespace std;
+
+bool readScenarios(const char* filename, int nVer, vector<vector<int>>& scenarios) {
+    ifstream inf(filename, ios::in);
+    if (!inf.is_open()) {
+        cerr << "Error: can't open scenario file " << filename << endl;
+        return false;
+    }
+
+    string line;
+    int lineno = 0;
+    while (getline(inf, line)) {
+        lineno++;
+        const char* p = line.c_str();
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (*p == '\0' || *p == '\r' || *p == '%' || *p == '#')
+            continue;
+
+        vector<int> b;
+        b.reserve(nVer);
+        char* end;
+        long v = strtol(p, &end, 10);
+        while (end != p) {
+            b.push_back(v);
+            p = end;
+            v = strtol(p, &end, 10);
+        }
+        if (b.size() != nVer) {
+            cerr << "Error: scenario on line " << lineno << " has " << b.size()
+                 << " b-values, expected " << nVer << endl;
+            return false;
+        }
+        scenarios.push_back(move(b));
+    }
+    return true;
+}
+
+void scenarioNodes(CSR* G, const vector<int>& b, vector<Node>& S) {
+    S.resize(G->nVer);
+    computeDegrees(G, S.data());
+    for (int i = 0; i < G->nVer; i++) {
+        S[i].b = b[(G->origId != NULL) ? G->origId[i] : i];
+    }
+}
+
+vector<AlgResult> runBatch(CSR* G, const vector<vector<int>>& scenarios, const function<AlgResult(Node*, Arena*)>& solve) {
+    vector<AlgResult> results(scenarios.size(), AlgResult(0, 0, 0));
+
+    #pragma omp parallel
+    {
+        Arena arena;
+        #pragma omp for schedule(dynamic, 1)
+        for (int k = 0; k < scenarios.size(); k++) {
+            vector<Node> S;
+            scenarioNodes(G, scenarios[k], S);
+            results[k] = solve(S.data(), &arena);
+        }
+    }
+    return results;
+}
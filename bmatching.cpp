@@ -0,0 +1,168 @@
+#include "include/bmatching.h"
+#include "include/graph.h"
+#include "include/auction.h"
+#include "include/components.h"
+#include "include/prune.h"
+#include "include/bvalues.h"
+#include "include/feasibility.h"
+#include <cstddef>
+#include <cfloat>
+#include <new>
+using namespace std;
+
+// The caller's edges are used as the CSR's verInd without a copy
+static_assert(sizeof(bm_edge) == sizeof(Edge) && offsetof(bm_edge, target) == offsetof(Edge, id)
+              && offsetof(bm_edge, weight) == offsetof(Edge, weight), "bm_edge must have the layout of Edge");
+
+int bm_api_version(void) {
+    return BM_API_VERSION;
+}
+
+void bm_default_options(bm_options* options) {
+    options->epsilon = 0.5;
+    options->algorithm = BM_MATCHING;
+    options->schedule = BM_SCHEDULE_FIFO;
+    options->cache_slack = 0;
+    options->decompose = 0;
+    options->prune_slack = -1;
+    options->sorted = 0;
+    options->fallback = 0;
+}
+
+// Wraps the caller's arrays in G as a one-sided CSR. Only the row pointers
+// are copied, extended with empty column rows. Returns false if the
+// arrays are not a valid instance.
+static bool wrapGraph(int32_t num_rows, int32_t num_cols, const int32_t* row_ptr, const bm_edge* edges, CSR& G) {
+    if (row_ptr[0] != 0)
+        return false;
+    int nVer = num_rows + num_cols;
+    int maxDeg = 0;
+    float maxWeight = 0;
+    for (int i = 0; i < num_rows; i++) {
+        if (row_ptr[i+1] < row_ptr[i])
+            return false;
+        maxDeg = max(maxDeg, row_ptr[i+1] - row_ptr[i]);
+        for (int j = row_ptr[i]; j < row_ptr[i+1]; j++) {
+            if (edges[j].target < num_rows || edges[j].target >= nVer)
+                return false;
+            maxWeight = max(maxWeight, edges[j].weight);
+        }
+    }
+
+    G.nVer = nVer;
+    G.lVer = num_rows;
+    G.rVer = num_cols;
+    G.nEdge = row_ptr[num_rows];
+    G.verPtr = new int[nVer + 1];
+    copy(row_ptr, row_ptr + num_rows + 1, G.verPtr);
+    fill(G.verPtr + num_rows + 1, G.verPtr + nVer + 1, G.nEdge);
+    G.verInd = (Edge*) edges;
+    G.oneSided = true;
+    G.maxDeg = maxDeg;
+    G.maxWeight = maxWeight;
+    G.avgDeg = nVer > 0 ? 2.0 * G.nEdge / nVer : 0;
+    return true;
+}
+
+static AlgResult solve(CSR* G, Node* S, const bm_options& opts, const AuctionOptions& aopts) {
+    if (opts.algorithm == BM_FACTOR) {
+        if (opts.decompose)
+            return componentAuction(G, S, opts.epsilon, true, false, aopts);
+        return bFactorAuction(G, S, opts.epsilon, false, aopts);
+    }
+    if (opts.prune_slack >= 0)
+        return prunedAuction(G, S, opts.epsilon, opts.prune_slack, false, aopts);
+    if (opts.decompose)
+        return componentAuction(G, S, opts.epsilon, false, false, aopts);
+    return bMatchingAuction(G, S, opts.epsilon, false, aopts);
+}
+
+int bm_solve(int32_t num_rows, int32_t num_cols, const int32_t* row_ptr, const bm_edge* edges,
+             const int32_t* b, const bm_options* options,
+             int32_t* match_rows, int32_t* match_cols, float* match_weights, int64_t capacity,
+             float* prices, bm_result* result) {
+    bm_options opts;
+    bm_default_options(&opts);
+    if (options != NULL)
+        opts = *options;
+
+    if (num_rows < 0 || num_cols < 0 || row_ptr == NULL || b == NULL || result == NULL || capacity < 0
+            || (row_ptr[num_rows] > 0 && edges == NULL) || (capacity > 0 && (match_rows == NULL || match_cols == NULL))
+            || (opts.algorithm != BM_MATCHING && opts.algorithm != BM_FACTOR)
+            || opts.schedule < BM_SCHEDULE_FIFO || opts.schedule > BM_SCHEDULE_LOCALITY || opts.epsilon <= 0)
+        return BM_ERR_ARGS;
+    for (int v = 0; v < num_rows + num_cols; v++) {
+        if (b[v] < 0)
+            return BM_ERR_ARGS;
+    }
+
+    CSR G;
+    bool owned = false;     // G.verInd is a sorted copy rather than the caller's array
+    int status = BM_OK;
+    try {
+        if (!wrapGraph(num_rows, num_cols, row_ptr, edges, G)) {
+            G.verInd = NULL;
+            return BM_ERR_ARGS;
+        }
+        if (opts.sorted) {
+            Edge* sorted = new Edge[G.nEdge];
+            copy(G.verInd, G.verInd + G.nEdge, sorted);
+            G.verInd = sorted;
+            owned = true;
+            G.sortByWeight();
+        }
+
+        vector<Node> S(G.nVer);
+        for (int v = 0; v < G.nVer; v++) {
+            S[v].b = b[v];
+        }
+        computeDegrees(&G, S.data());
+
+        if (opts.algorithm == BM_FACTOR) {
+            FeasibilityReport report;
+            if (!checkBFactor(&G, S.data(), report)) {
+                if (!opts.fallback) {
+                    result->weight = 0;
+                    result->time = 0;
+                    result->num_matched = 0;
+                    if (!owned)
+                        G.verInd = NULL;    // Belongs to the caller
+                    return BM_ERR_INFEASIBLE;
+                }
+                opts.algorithm = BM_MATCHING;
+                status = BM_FALLBACK;
+            }
+        }
+
+        AuctionOutput out;
+        AuctionOptions aopts;
+        aopts.schedule = (SchedulePolicy) opts.schedule;
+        aopts.cache_slack = max(0, opts.cache_slack);
+        aopts.out = &out;
+        AlgResult res = solve(&G, S.data(), opts, aopts);
+
+        result->weight = res.weight;
+        result->time = res.total_time;
+        result->num_matched = out.matching.size();
+        if (result->num_matched > capacity) {
+            status = BM_ERR_CAPACITY;
+        }
+        else {
+            for (long k = 0; k < out.matching.size(); k++) {
+                match_rows[k] = out.matching[k].bidder;
+                match_cols[k] = out.matching[k].object - num_rows;
+                if (match_weights != NULL)
+                    match_weights[k] = out.matching[k].weight;
+            }
+        }
+        if (prices != NULL)
+            copy(out.prices.begin(), out.prices.end(), prices);
+    }
+    catch (...) {
+        status = BM_ERR_INTERNAL;
+    }
+
+    if (!owned)
+        G.verInd = NULL;    // Belongs to the caller
+    return status;
+}
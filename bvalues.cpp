@@ -0,0 +1,126 @@
+#include "include/bvalues.h"
+#include <algorithm>
+#include <cstring>
+#include <parallel/algorithm>
+using namespace std;
+
+void computeDegrees(CSR* G, Node* S) {
+    #pragma omp parallel for schedule(static, 4096)
+    for (int i = 0; i < G->nVer; i++) {
+        int deg = 0;
+        if (i < G->lVer) {
+            forEachEdge(G, i, [&](Edge e) {
+                if (e.weight >= 0)
+                    deg++;
+            });
+        }
+        else {
+            for (int j = G->verPtr[i]; j < G->verPtr[i+1]; j++) {
+                if (G->verInd[j].weight >= 0)
+                    deg++;
+            }
+        }
+        S[i].deg = deg;
+    }
+
+    // Without right-side rows the right degrees are counted from the left side
+    if (G->oneSided) {
+        #pragma omp parallel for schedule(static, 4096)
+        for (int i = 0; i < G->lVer; i++) {
+            forEachEdge(G, i, [&](Edge e) {
+                if (e.weight >= 0) {
+                    #pragma omp atomic
+                    S[e.id].deg++;
+                }
+            });
+        }
+    }
+}
+
+void randomBValues(CSR* G, Node* S, uint64_t seed) {
+    computeDegrees(G, S);
+    #pragma omp parallel for schedule(static, 4096)
+    for (int i = 0; i < G->nVer; i++) {
+        S[i].b = randomInRange(seed, i, 1, 10);
+    }
+}
+
+long randomBFactorValues(CSR* G, Node* S, uint64_t seed) {
+    computeDegrees(G, S);
+
+    // Random pairing of left vertices with right vertices: the right vertices
+    // sorted by a counter-based key, the same for every thread count. The
+    // keys draw from counters lVer..nVer-1, which the left b-values don't use.
+    vector<pair<uint64_t, int>> keys(G->rVer);
+    #pragma omp parallel for schedule(static, 4096)
+    for (int k = 0; k < G->rVer; k++) {
+        int v = G->lVer + k;
+        keys[k] = make_pair(splitmix64(seed ^ splitmix64(v)), v);
+    }
+    __gnu_parallel::sort(keys.begin(), keys.end());
+    vector<int> perm(G->rVer);
+    #pragma omp parallel for schedule(static, 4096)
+    for (int k = 0; k < G->rVer; k++) {
+        perm[k] = keys[k].second;
+    }
+
+    #pragma omp parallel for schedule(static, 4096)
+    for (int k = 0; k < G->rVer; k++) {
+        S[G->lVer + k].b = 0;
+    }
+
+    long cardF = 0;
+    #pragma omp parallel for schedule(static, 4096) reduction(+:cardF)
+    for (int i = 0; i < G->lVer; i++) {
+        int b = randomInRange(seed, i, 1, max(1, S[i].deg / 2));
+        S[i].b = b;
+        if (i < G->rVer)
+            S[perm[i]].b = b;
+        cardF += b;
+    }
+    return cardF;
+}
+
+bool readBValues(const char* filename, CSR* G, Node* S) {
+    size_t len = strlen(filename);
+    bool binary = len >= 4 && strcmp(filename + len - 4, ".bin") == 0;
+
+    ifstream inf(filename, binary ? ios::in | ios::binary : ios::in);
+    if (!inf.is_open()) {
+        cerr << "Error: can't open b-value file " << filename << endl;
+        return false;
+    }
+
+    vector<int> b(G->nVer);
+    if (binary) {
+        inf.read((char*) b.data(), sizeof(int) * G->nVer);
+        if (inf.gcount() != sizeof(int) * G->nVer) {
+            cerr << "Error: " << filename << " holds fewer than " << G->nVer << " b-values" << endl;
+            return false;
+        }
+    }
+    else {
+        string text((istreambuf_iterator<char>(inf)), istreambuf_iterator<char>());
+        const char* p = text.c_str();
+        char* end;
+        for (int i = 0; i < G->nVer; i++) {
+            long v = strtol(p, &end, 10);
+            if (end == p) {
+                cerr << "Error: " << filename << " holds fewer than " << G->nVer << " b-values" << endl;
+                return false;
+            }
+            b[i] = v;
+            p = end;
+        }
+    }
+
+    for (int i = 0; i < G->nVer; i++) {
+        if (b[i] < 0) {
+            cerr << "Error: negative b-value for vertex " << i << endl;
+            return false;
+        }
+        S[i].b = b[i];
+    }
+    computeDegrees(G, S);
+    return true;
+}
@@ -0,0 +1,53 @@
+#include "include/cardinality.h"
+#include "include/flow.h"
+using namespace std;
+
+AlgResult cardinalityBMatching(CSR* G, Node* S, const AuctionOptions& aopts) {
+    double start = omp_get_wtime();
+    if (aopts.prof) aopts.prof->begin("Matching Init");
+    FlowNetwork net(G, S);
+    net.greedy();
+    double time_init = omp_get_wtime();
+    if (aopts.prof) {
+        aopts.prof->end();
+        aopts.prof->begin("Augmenting Paths");
+    }
+
+    net.maxFlow();
+    double end = omp_get_wtime();
+    if (aopts.prof) {
+        aopts.prof->end();
+        aopts.prof->begin("Weight Sum");
+    }
+
+    double weight = 0;
+    #pragma omp parallel for schedule(static, 4096) reduction(+:weight)
+    for (int i = 0; i < G->lVer; i++) {
+        int k = G->verPtr[i];
+        forEachEdge(G, i, [&](Edge e) {
+            if (net.flow[k++])
+                weight += e.weight;
+        });
+    }
+    if (aopts.prof) aopts.prof->end();
+
+    if (aopts.out) {
+        // The last search stopped short of the sink, so levR marks the
+        // right vertices still reachable from a left vertex with room
+        AuctionOutput& out = *aopts.out;
+        out.prices.resize(G->rVer);
+        for (int j = 0; j < G->rVer; j++) {
+            out.prices[j] = (S[G->lVer + j].b == 0) ? FLT_MAX : (net.levR[j] >= 0) ? 1 : 0;
+        }
+        out.matching.clear();
+        for (int i = 0; i < G->lVer; i++) {
+            int k = G->verPtr[i];
+            forEachEdge(G, i, [&](Edge e) {
+                if (net.flow[k++])
+                    out.matching.push_back(MatchedEdge(i, e.id, e.weight, out.prices[e.id - G->lVer]));
+            });
+        }
+    }
+
+    return AlgResult(end - start, time_init - start, weight);
+}
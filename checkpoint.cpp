@@ -0,0 +1,101 @@
+#include "include/checkpoint.h"
+#include <omp.h>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+using namespace std;
+
+const char checkpointMagic[8] = {'B', 'M', 'C', 'K', 'P', 'T', 0, 1};
+
+uint64_t hashBValues(Node* S, int n) {
+    uint64_t h = 14695981039346656037ULL;     // FNV-1a
+    for (int i = 0; i < n; i++) {
+        h = (h ^ (uint32_t) S[i].b) * 1099511628211ULL;
+    }
+    return h;
+}
+
+static bool writeSnapshot(const string& filename, const AuctionSnapshot& snap) {
+    string tmp = filename + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (f == NULL)
+        return false;
+    bool ok = fwrite(&snap.header, sizeof(CheckpointHeader), 1, f) == 1;
+    ok = ok && fwrite(snap.copies.data(), sizeof(CopyState), snap.copies.size(), f) == snap.copies.size();
+    ok = ok && fwrite(snap.flags.data(), 1, snap.flags.size(), f) == snap.flags.size();
+    ok = ok && fwrite(snap.queue.data(), sizeof(int32_t), snap.queue.size(), f) == snap.queue.size();
+    ok = (fclose(f) == 0) && ok;
+    return ok && rename(tmp.c_str(), filename.c_str()) == 0;
+}
+
+Checkpointer::Checkpointer(const string& filename, double interval)
+    : filename(filename), interval(interval), last(omp_get_wtime()), next(0), busy(false), count(0) { }
+
+Checkpointer::~Checkpointer() {
+    finish();
+}
+
+bool Checkpointer::due(AuctionSnapshot*& snap) {
+    if (busy.load() || omp_get_wtime() - last < interval)
+        return false;
+    if (writer.joinable())
+        writer.join();
+    last = omp_get_wtime();
+    snap = &buffers[next];
+    return true;
+}
+
+void Checkpointer::submit(AuctionSnapshot* snap) {
+    next = 1 - next;
+    busy.store(true);
+    writer = thread([this, snap]() {
+        if (writeSnapshot(filename, *snap))
+            count++;
+        else
+            cerr << "Warning: can't write checkpoint " << filename << endl;
+        busy.store(false);
+    });
+}
+
+void Checkpointer::finish() {
+    if (writer.joinable())
+        writer.join();
+}
+
+// True if the sections the header announces fill exactly the rest of the
+// file, checked before anything is sized by the counts
+static bool countsFit(const CheckpointHeader& h, int64_t remaining) {
+    if (h.numCopies < 0 || h.numBidders < 0 || h.numQueued < 0)
+        return false;
+    if (h.numCopies > remaining / (int64_t) sizeof(CopyState))
+        return false;
+    remaining -= h.numCopies * (int64_t) sizeof(CopyState);
+    if (h.numBidders > remaining)
+        return false;
+    remaining -= h.numBidders;
+    return remaining == h.numQueued * (int64_t) sizeof(int32_t);
+}
+
+bool readCheckpoint(const char* filename, AuctionSnapshot& snap) {
+    FILE* f = fopen(filename, "rb");
+    if (f == NULL)
+        return false;
+    int64_t size = -1;
+    if (fseek(f, 0, SEEK_END) == 0)
+        size = ftell(f);
+    rewind(f);
+    CheckpointHeader& h = snap.header;
+    bool ok = size >= (int64_t) sizeof(CheckpointHeader)
+           && fread(&h, sizeof(CheckpointHeader), 1, f) == 1 && memcmp(h.magic, checkpointMagic, sizeof(h.magic)) == 0
+           && countsFit(h, size - (int64_t) sizeof(CheckpointHeader));
+    if (ok) {
+        snap.copies.resize(h.numCopies);
+        snap.flags.resize(h.numBidders);
+        snap.queue.resize(h.numQueued);
+        ok = fread(snap.copies.data(), sizeof(CopyState), h.numCopies, f) == (size_t) h.numCopies
+          && fread(snap.flags.data(), 1, h.numBidders, f) == (size_t) h.numBidders
+          && fread(snap.queue.data(), sizeof(int32_t), h.numQueued, f) == (size_t) h.numQueued;
+    }
+    fclose(f);
+    return ok;
+}
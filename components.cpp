@@ -0,0 +1,199 @@
+#include "include/components.h"
+#include <algorithm>
+#include <cfloat>
+using namespace std;
+
+static int findRoot(vector<int>& parent, int v) {
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];  // Path halving
+        v = parent[v];
+    }
+    return v;
+}
+
+vector<Component> findComponents(CSR* G) {
+    vector<int> parent(G->nVer);
+    for (int v = 0; v < G->nVer; v++) {
+        parent[v] = v;
+    }
+
+    for (int i = 0; i < G->lVer; i++) {
+        for (int j = G->verPtr[i]; j < G->verPtr[i+1]; j++) {
+            if (G->verInd[j].weight < 0)
+                continue;
+            int ri = findRoot(parent, i);
+            int rj = findRoot(parent, G->verInd[j].id);
+            if (ri != rj)
+                parent[max(ri, rj)] = min(ri, rj);
+        }
+    }
+
+    // Number the components by their roots
+    vector<int> compId(G->nVer, -1);
+    vector<Component> comps;
+    for (int v = 0; v < G->nVer; v++) {
+        int r = findRoot(parent, v);
+        if (compId[r] < 0) {
+            compId[r] = comps.size();
+            comps.push_back(Component());
+        }
+        Component& c = comps[compId[r]];
+        c.vertices.push_back(v);
+        if (v < G->lVer)
+            c.lVer++;
+    }
+
+    for (int i = 0; i < G->lVer; i++) {
+        for (int j = G->verPtr[i]; j < G->verPtr[i+1]; j++) {
+            if (G->verInd[j].weight >= 0)
+                comps[compId[findRoot(parent, i)]].nEdge++;
+        }
+    }
+
+    comps.erase(remove_if(comps.begin(), comps.end(), [](const Component& c) { return c.nEdge == 0; }), comps.end());
+    stable_sort(comps.begin(), comps.end(), [](const Component& a, const Component& b) { return a.nEdge > b.nEdge; });
+    return comps;
+}
+
+void extractComponent(CSR* G, Node* S, const Component& c, const vector<int>& localId, CSR& sub, vector<Node>& subS) {
+    int n = c.vertices.size();
+    sub.nVer = n;
+    sub.lVer = c.lVer;
+    sub.rVer = n - c.lVer;
+    sub.verPtr = new int[n+1];
+    sub.origId = new int[n];
+    subS.resize(n);
+
+    sub.verPtr[0] = 0;
+    for (int v = 0; v < n; v++) {
+        int g = c.vertices[v];
+        int deg = 0;
+        for (int j = G->verPtr[g]; j < G->verPtr[g+1]; j++) {
+            if (G->verInd[j].weight >= 0)
+                deg++;
+        }
+        sub.verPtr[v+1] = sub.verPtr[v] + deg;
+        sub.origId[v] = (G->origId != NULL) ? G->origId[g] : g;
+        subS[v] = S[g];
+    }
+
+    sub.nEdge = sub.verPtr[n];
+    sub.verInd = new Edge[sub.nEdge];
+    int maxDeg = 0;
+    for (int v = 0; v < n; v++) {
+        int g = c.vertices[v];
+        int k = sub.verPtr[v];
+        for (int j = G->verPtr[g]; j < G->verPtr[g+1]; j++) {
+            if (G->verInd[j].weight >= 0)
+                sub.verInd[k++] = Edge(localId[G->verInd[j].id], G->verInd[j].weight);
+        }
+        maxDeg = max(maxDeg, sub.verPtr[v+1] - sub.verPtr[v]);
+    }
+    sub.maxDeg = maxDeg;
+    sub.maxWeight = G->maxWeight;
+    sub.avgDeg = (double) sub.nEdge / n;
+    sub.weightSorted = G->weightSorted;
+    sub.oneSided = G->oneSided;
+}
+
+AlgResult componentAuction(CSR* G, Node* S, double epsilon, bool perfect, bool verbose, const AuctionOptions& aopts) {
+    double start = omp_get_wtime();
+    if (aopts.prof) aopts.prof->begin("Components");
+
+    vector<Component> comps = findComponents(G);
+    vector<int> localId(G->nVer, -1);
+    for (auto& c : comps) {
+        for (int v = 0; v < c.vertices.size(); v++) {
+            localId[c.vertices[v]] = v;
+        }
+    }
+    if (verbose)
+        cout << "Connected components with edges: " << comps.size() << endl;
+
+    double time_init = omp_get_wtime();
+    if (aopts.prof) {
+        aopts.prof->end();
+        aopts.prof->begin("Component Solves");
+    }
+
+    // The profiler is not thread safe, so the solves run without it
+    AuctionOptions sub_opts = aopts;
+    sub_opts.prof = NULL;
+    sub_opts.out = NULL;
+    sub_opts.checkpoint_file = NULL;    // Snapshots cover a whole graph, not a component
+    sub_opts.resume_file = NULL;
+    sub_opts.progress = nullptr;        // Would be called concurrently and per component
+    bool limited = aopts.deadline > 0 || aopts.bid_budget > 0;
+    atomic<long> rounds(0);
+    sub_opts.shared_rounds = aopts.shared_rounds ? aopts.shared_rounds : &rounds;   // One bid budget for all the components
+
+    // Objects outside every component keep their initial price
+    if (aopts.out) {
+        aopts.out->matching.clear();
+        aopts.out->prices.resize(G->rVer);
+        for (int o = 0; o < G->rVer; o++) {
+            aopts.out->prices[o] = (S[G->lVer + o].b > 0) ? 0 : FLT_MAX;
+        }
+    }
+
+    double weight = 0, bound = 0;
+    bool interrupted = false;
+    STATS_DO(AuctionStats stats;)
+    // The caller's arena is not thread safe, so each thread has its own,
+    // reused by its component solves as in runBatch
+    #pragma omp parallel
+    {
+        Arena arena;
+        #pragma omp for schedule(dynamic, 1) reduction(+:weight,bound) reduction(||:interrupted)
+        for (int k = 0; k < comps.size(); k++) {
+            CSR sub;
+            vector<Node> subS;
+            extractComponent(G, S, comps[k], localId, sub, subS);
+
+            AuctionOptions thread_opts = sub_opts;
+            thread_opts.arena = &arena;
+            if (aopts.deadline > 0)
+                thread_opts.deadline = max(1e-6, aopts.deadline - (omp_get_wtime() - time_init));
+            AuctionOutput sub_out;
+            if (aopts.out || limited)
+                thread_opts.out = &sub_out;
+            AlgResult res = perfect ? bFactorAuction(&sub, subS.data(), epsilon, false, thread_opts)
+                                    : bMatchingAuction(&sub, subS.data(), epsilon, false, thread_opts);
+            weight += res.weight;
+
+            // The bound is the sum of the components', including finished ones
+            if (limited && !perfect) {
+                interrupted = interrupted || res.interrupted;
+                bound += res.interrupted ? res.bound : matchingDualBound(&sub, subS.data(), sub_out.prices);
+            }
+
+            // Map the component's ids back to G
+            if (aopts.out) {
+                const vector<int>& ids = comps[k].vertices;
+                for (int o = 0; o < sub.rVer; o++) {
+                    aopts.out->prices[ids[sub.lVer + o] - G->lVer] = sub_out.prices[o];
+                }
+                for (auto& m : sub_out.matching) {
+                    m.bidder = ids[m.bidder];
+                    m.object = ids[m.object];
+                }
+                #pragma omp critical
+                aopts.out->matching.insert(aopts.out->matching.end(), sub_out.matching.begin(), sub_out.matching.end());
+            }
+#ifdef AUCTION_STATS
+            #pragma omp critical
+            stats.add(res.stats);
+#endif
+        }
+    }
+
+    double end = omp_get_wtime();
+    if (aopts.prof) aopts.prof->end();
+
+    AlgResult res(end - start, time_init - start, weight);
+    res.interrupted = interrupted;
+    if (interrupted)
+        res.bound = bound;
+    STATS_DO(res.stats = stats;)
+    return res;
+}
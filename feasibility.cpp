@@ -0,0 +1,53 @@
+#include "include/feasibility.h"
+#include "include/flow.h"
+using namespace std;
+
+bool checkBFactor(CSR* G, Node* S, FeasibilityReport& report) {
+    report = FeasibilityReport();
+    long left = 0, right = 0;
+    #pragma omp parallel for reduction(+:left) schedule(static)
+    for (int i = 0; i < G->lVer; i++) {
+        left += S[i].b;
+    }
+    #pragma omp parallel for reduction(+:right) schedule(static)
+    for (int i = G->lVer; i < G->nVer; i++) {
+        right += S[i].b;
+    }
+    report.leftTotal = left;
+    report.rightTotal = right;
+
+    // Neighbors that could take part in a perfect b-matching, counted from
+    // the left-side rows for both sides
+    vector<int> deg(G->nVer, 0);
+    #pragma omp parallel for schedule(static, 4096)
+    for (int i = 0; i < G->lVer; i++) {
+        if (S[i].b == 0)
+            continue;
+        forEachEdge(G, i, [&](Edge e) {
+            if (e.weight >= 0 && S[e.id].b > 0) {
+                deg[i]++;
+                #pragma omp atomic
+                deg[e.id]++;
+            }
+        });
+    }
+    for (int v = 0; v < G->nVer; v++) {
+        if (deg[v] < S[v].b)
+            report.deficient.push_back(v);
+    }
+    if (!report.deficient.empty())
+        return false;
+
+    FlowNetwork net(G, S);
+    report.maxEdges = net.greedy();
+    report.maxEdges += net.maxFlow();
+    for (int i = 0; i < G->lVer; i++) {
+        if (net.outL[i] < S[i].b)
+            report.deficient.push_back(i);
+    }
+    for (int j = 0; j < G->rVer; j++) {
+        if (net.inR[j] < S[G->lVer + j].b)
+            report.deficient.push_back(G->lVer + j);
+    }
+    return report.deficient.empty();
+}
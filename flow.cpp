@@ -0,0 +1,220 @@
+#include "include/flow.h"
+#include <algorithm>
+#include <climits>
+using namespace std;
+
+FlowNetwork::FlowNetwork(CSR* G, Node* S, const vector<char>* allowed) : G(G), S(S) {
+    int nL = G->lVer, nR = G->rVer;
+    int m = G->verPtr[nL];
+    usable.assign(m, 0);
+    flow.assign(m, 0);
+    rowOf.resize(m);
+    col.resize(m);
+    #pragma omp parallel
+    {
+        vector<int> lastRow(nR, -1);    // Last row with an edge into each right vertex
+        #pragma omp for schedule(static, 4096)
+        for (int i = 0; i < nL; i++) {
+            int k = G->verPtr[i];
+            forEachEdge(G, i, [&](Edge e) {
+                int j = e.id - nL;
+                rowOf[k] = i;
+                col[k] = j;
+                usable[k] = e.weight >= 0 && S[i].b > 0 && S[e.id].b > 0 && lastRow[j] != i
+                            && (allowed == NULL || (*allowed)[k]);
+                if (usable[k])
+                    lastRow[j] = i;
+                k++;
+            });
+        }
+    }
+
+    rightPtr.assign(nR + 1, 0);
+    for (int k = 0; k < m; k++) {
+        if (usable[k])
+            rightPtr[col[k] + 1]++;
+    }
+    for (int j = 0; j < nR; j++) {
+        rightPtr[j+1] += rightPtr[j];
+    }
+    rightEdge.resize(rightPtr[nR]);
+    vector<int> next(rightPtr.begin(), rightPtr.end() - 1);
+    for (int k = 0; k < m; k++) {
+        if (usable[k])
+            rightEdge[next[col[k]]++] = k;
+    }
+
+    outL.assign(nL, 0);
+    inR.assign(nR, 0);
+    levL.resize(nL);
+    levR.resize(nR);
+    itL.resize(nL);
+    itR.resize(nR);
+}
+
+long FlowNetwork::greedy() {
+    int nL = G->lVer;
+    long added = 0;
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(+:added)
+    for (int i = 0; i < nL; i++) {
+        for (int k = G->verPtr[i]; k < G->verPtr[i+1] && outL[i] < S[i].b; k++) {
+            if (!usable[k] || flow[k])
+                continue;
+            int j = col[k];
+            int taken;
+            #pragma omp atomic read
+            taken = inR[j];
+            if (taken >= S[nL + j].b)
+                continue;
+
+            // Reserve a unit of the right vertex, and hand it back if
+            // another left vertex got there first
+            #pragma omp atomic capture
+            taken = inR[j]++;
+            if (taken < S[nL + j].b) {
+                flow[k] = 1;
+                outL[i]++;
+                added++;
+            }
+            else {
+                #pragma omp atomic
+                inR[j]--;
+            }
+        }
+    }
+    return added;
+}
+
+bool FlowNetwork::levels() {
+    int nL = G->lVer;
+    fill(levL.begin(), levL.end(), -1);
+    fill(levR.begin(), levR.end(), -1);
+    sinkLevel = INT_MAX;
+
+    vector<int> frontier;   // Left vertices at even levels, right vertices at odd ones
+    for (int i = 0; i < nL; i++) {
+        if (outL[i] < S[i].b) {
+            levL[i] = 0;
+            frontier.push_back(i);
+        }
+    }
+    for (int d = 0; !frontier.empty(); d++) {
+        bool left = (d % 2 == 0);
+        if (!left) {
+            bool sink = false;
+            #pragma omp parallel for schedule(static) reduction(||:sink)
+            for (size_t h = 0; h < frontier.size(); h++) {
+                int j = frontier[h];
+                sink = sink || inR[j] < S[nL + j].b;
+            }
+            if (sink) {
+                sinkLevel = d + 1;
+                break;
+            }
+        }
+
+        // Each vertex of the next level is claimed by the first thread to
+        // reach it
+        vector<int> next;
+        #pragma omp parallel
+        {
+            vector<int> found;
+            #pragma omp for schedule(dynamic, 256) nowait
+            for (size_t h = 0; h < frontier.size(); h++) {
+                int v = frontier[h];
+                if (left) {
+                    for (int k = G->verPtr[v]; k < G->verPtr[v+1]; k++) {
+                        int j = col[k];
+                        if (usable[k] && !flow[k] && levR[j] < 0 && __sync_bool_compare_and_swap(&levR[j], -1, d + 1))
+                            found.push_back(j);
+                    }
+                }
+                else {
+                    for (int p = rightPtr[v]; p < rightPtr[v+1]; p++) {
+                        int k = rightEdge[p];
+                        int i = rowOf[k];
+                        if (flow[k] && levL[i] < 0 && __sync_bool_compare_and_swap(&levL[i], -1, d + 1))
+                            found.push_back(i);
+                    }
+                }
+            }
+            #pragma omp critical
+            next.insert(next.end(), found.begin(), found.end());
+        }
+        frontier.swap(next);
+    }
+
+    for (int i = 0; i < nL; i++) {
+        itL[i] = G->verPtr[i];
+    }
+    for (int j = 0; j < G->rVer; j++) {
+        itR[j] = rightPtr[j];
+    }
+    return sinkLevel != INT_MAX;
+}
+
+// Pushes one unit from root along a shortest augmenting path, depth first
+// with an explicit stack. Vertices found to lead nowhere are cut from the
+// level graph.
+bool FlowNetwork::augment(int root, vector<int>& path, vector<int>& via) {
+    int nL = G->lVer;
+    path.assign(1, root);
+    via.assign(1, -1);
+    while (!path.empty()) {
+        int v = path.back();
+        bool advanced = false;
+        if (v >= nL) {
+            int j = v - nL;
+            if (inR[j] < S[v].b && levR[j] + 1 == sinkLevel) {
+                for (size_t d = 1; d < path.size(); d++) {
+                    flow[via[d]] = (path[d] >= nL);    // Forward arcs gain flow, backward arcs lose it
+                }
+                outL[root]++;
+                inR[j]++;
+                return true;
+            }
+            for (; itR[j] < rightPtr[j+1]; itR[j]++) {
+                int k = rightEdge[itR[j]];
+                if (flow[k] && levL[rowOf[k]] == levR[j] + 1) {
+                    path.push_back(rowOf[k]);
+                    via.push_back(k);
+                    advanced = true;
+                    break;
+                }
+            }
+            if (!advanced)
+                levR[j] = -1;
+        }
+        else {
+            for (; itL[v] < G->verPtr[v+1]; itL[v]++) {
+                int k = itL[v];
+                int j = col[k];
+                if (usable[k] && !flow[k] && levR[j] == levL[v] + 1) {
+                    path.push_back(nL + j);
+                    via.push_back(k);
+                    advanced = true;
+                    break;
+                }
+            }
+            if (!advanced)
+                levL[v] = -1;
+        }
+        if (!advanced) {
+            path.pop_back();
+            via.pop_back();
+        }
+    }
+    return false;
+}
+
+long FlowNetwork::maxFlow() {
+    long total = 0;
+    vector<int> path, via;
+    while (levels()) {
+        for (int i = 0; i < G->lVer; i++) {
+            while (levL[i] == 0 && outL[i] < S[i].b && augment(i, path, via))
+                total++;
+        }
+    }
+    return total;
+}
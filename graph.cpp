@@ -1,138 +1,305 @@
 #include "include/graph.h"
+#include "include/stream.h"
 #include <cstring>
+#include <cstdint>
+#include <climits>
+#include <cctype>
+#include <algorithm>
 using namespace std;
 
-bool CSR::readMtxB(char* filename, bool abs_value, bool verbose) {
-    int count = 0, i, j;
-    int inp, m1, edgecnt_;
+// Input from a ByteStream, buffered and kept NUL-terminated with at least a
+// line's worth of bytes ahead of the read position so that strtol and strtod
+// never see a number cut at a refill
+class TokenReader {
+    public:
+    TokenReader(ByteStream* in) : in(in), buf(bufSize + 1), pos(0), end(0), eof(false) {
+        refill();
+    }
+
+    // True if the input starts with a printable '%' line, as a MatrixMarket
+    // header does; binary ids rarely avoid zero bytes for a whole line
+    bool startsWithComment() {
+        if (pos == end || buf[pos] != '%')
+            return false;
+        for (size_t k = pos; k < end && buf[k] != '\n'; k++) {
+            if (!isprint((unsigned char) buf[k]) && buf[k] != '\t' && buf[k] != '\r')
+                return false;
+        }
+        return true;
+    }
+
+    int peek() {
+        refill();
+        return (pos < end) ? buf[pos] : EOF;
+    }
+
+    bool readLine(string& s) {
+        s.clear();
+        while (peek() != EOF) {
+            char c = buf[pos++];
+            if (c == '\n')
+                return true;
+            s += c;
+        }
+        return !s.empty();
+    }
+
+    bool readInt(long& v) {
+        if (!skipSpace())
+            return false;
+        char* stop;
+        v = strtol(buf.data() + pos, &stop, 10);
+        return advance(stop);
+    }
+
+    // Raw bytes, for binary input
+    size_t read(char* dst, size_t cap) {
+        size_t n = min(cap, end - pos);
+        memcpy(dst, buf.data() + pos, n);
+        pos += n;
+        if (n < cap && !eof)
+            n += in->read(dst + n, cap - n);
+        return n;
+    }
+
+    bool readDouble(double& v) {
+        if (!skipSpace())
+            return false;
+        char* stop;
+        v = strtod(buf.data() + pos, &stop);
+        return advance(stop);
+    }
+
+    private:
+    static const size_t bufSize = 1 << 20;
+    static const size_t lookahead = 256;
+
+    ByteStream* in;
+    vector<char> buf;
+    size_t pos, end;
+    bool eof;
+
+    void refill() {
+        if (eof || end - pos >= lookahead)
+            return;
+        memmove(buf.data(), buf.data() + pos, end - pos);
+        end -= pos;
+        pos = 0;
+        size_t n = in->read(buf.data() + end, bufSize - end);
+        end += n;
+        eof = (n == 0);
+        buf[end] = '\0';
+    }
+
+    bool skipSpace() {
+        while (peek() != EOF && isspace((unsigned char) buf[pos]))
+            pos++;
+        refill();
+        return pos < end;
+    }
+
+    bool advance(char* stop) {
+        if (stop == buf.data() + pos)
+            return false;
+        pos = stop - buf.data();
+        return true;
+    }
+};
+
+// Entries of the input before the CSR is built. Ids are 0-based and right
+// ids are already offset by lVer.
+struct EdgeInput {
+    int lVer, rVer;
     bool sym;
-    int numRow, numCol, nonZeros, numEdges;
-    double f;
+    bool pattern = false;   // Pattern matrix read with unit weights
+    vector<int> left, right;
+    vector<float> weight;
+};
+
+static bool readMatrixMarket(TokenReader& in, const char* filename, EdgeInput& E, bool random_weights) {
     string s;
-    ifstream inf;
+    in.readLine(s);
+    bool pattern = s.find("pattern") != string::npos;
+    if (s.find("symmetric") != string::npos || s.find("hermitian") != string::npos
+        || s.find("skew-symmetric") != string::npos) {
+        E.sym = true;
+        cout << "Symmetric matrix" << endl;
+    }
+    else {
+        E.sym = false;
+    }
+    if (pattern && !random_weights) {
+        E.pattern = true;
+        cout << "Pattern matrix: every edge weighs 1" << endl;
+    }
+    while (in.peek() == '%') {
+        in.readLine(s);
+    }
+
+    if (!E.sym) {
+        cout << endl << "WARNING..!!" << endl;
+        cout << "The mtx file contains full matrix" << endl;
+        cout << "User has to make sure that input file has both (i,j) and (j,i) present." << endl;
+        cout << "Matching is not defined if w(i,j) != w(j,i)" << endl << endl;
+    }
 
-    inf.open(filename, ios::in);
+    long numRow, numCol, nonZeros;
+    if (!in.readInt(numRow) || !in.readInt(numCol) || !in.readInt(nonZeros)
+        || numRow < 0 || numCol < 0 || nonZeros < 0 || numRow + numCol > INT_MAX) {
+        cerr << "Error: bad size line in " << filename << endl;
+        return false;
+    }
+    E.lVer = numRow;
+    E.rVer = numCol;
+    E.left.reserve(nonZeros);
+    E.right.reserve(nonZeros);
+    E.weight.reserve(nonZeros);
 
-    if (inf.is_open()) {
-        size_t found1, found2, found3;
-        getline(inf,s);
-        found1 = s.find("pattern");
-        if (found1 != string::npos) {
-            m1 = 2;
-        }
-        else {
-            m1 = 3;
-        }
-        found1 = s.find("symmetric");
-        found2 = s.find("hermitian");
-        found3 = s.find("skew-symmetric");
-        if (found1 != string::npos || found2 != string::npos || found3 != string::npos) {
-            sym = true;
-            cout << "Symmetric matrix" << endl;
-        }
-        else {
-            sym = false;
-        }
-        while (inf.peek() == '%') {
-            getline(inf,s);
+    for (long k = 0; k < nonZeros; k++) {
+        long i, j;
+        double f = 0;
+        if (!in.readInt(i) || !in.readInt(j) || (!pattern && !in.readDouble(f))) {
+            cerr << "Error: " << filename << " ends after " << k << " of " << nonZeros << " entries" << endl;
+            return false;
         }
-        
-        if (!sym) {    
-            cout << endl << "WARNING..!!" << endl;
-            cout << "The mtx file contains full matrix" << endl;
-            cout << "User has to make sure that input file has both (i,j) and (j,i) present." << endl;
-            cout << "Matching is not defined if w(i,j) != w(j,i)" << endl << endl;
+        if (i < 1 || i > numRow || j < 1 || j > numCol) {
+            cerr << "Error: entry " << k + 1 << " (" << i << ", " << j << ") of " << filename << " is out of range" << endl;
+            return false;
         }
- 
-        inf >> inp;
-        numRow = inp;
-        inf >> inp;
-        numCol = inp;
-        inf >> inp;
-        nonZeros = inp;
-
-        lVer = numRow;
-        rVer = numCol;
-        nVer = lVer+rVer;
-
-        count = inp;
-        
-        vector<vector<int>> graphCRSIdx(nVer);
-        vector<vector<double>> graphCRSVal(nVer);
-        int diag = 0;
-        
-        while (count > 0) {     
-            inf >> i; 
-            inf >> j;
-
-            j += lVer; //adjusting for the right hand vertices
-            
-            if (m1 == 3) {
-                inf >> f; 
-            }
-            else {
-                f = drand48()*1000000;
-            }
+        if (pattern)
+            f = random_weights ? drand48()*1000000 : 1;
 
-            if (i == j) {
-                diag++;
-            }
-            else {
-                graphCRSIdx[i-1].push_back(j-1); 
-                graphCRSVal[i-1].push_back(f);
-                if (sym) {
-                    graphCRSIdx[j-1].push_back(i-1); 
-                    graphCRSVal[j-1].push_back(f); 
-                }
-            }   
-            count--; 
-        }     
-        inf.close(); 
-     
-        numEdges = nonZeros;  
-        if (sym) //symmetric matrix
-            numEdges = nonZeros*2 - 2*diag;
-
-        nEdge = numEdges;
-        
-        verPtr = new int[nVer+1];
-        verInd = new Edge[nEdge];
-
-        verPtr[0] = 0;
-        int max = 0, offset; 
-        maxWeight = 0;
-        int totalDeg = 0;
-        for (int i = 1; i <= nVer; i++) {
-            offset = graphCRSIdx[i-1].size();
-            totalDeg += offset;
-            verPtr[i] = verPtr[i-1] + offset;
-            count = verPtr[i-1];
-            for (int j = 0; j < offset; j++) {
-                verInd[count].id = graphCRSIdx[i-1][j];
-                if (abs_value) {
-                    verInd[count].weight = abs(graphCRSVal[i-1][j]);
-                }
-                else {
-                    verInd[count].weight = graphCRSVal[i-1][j];
-                }
-                if (verInd[count].weight > maxWeight) {
-                    maxWeight = verInd[count].weight;
-                }
-                count++;
+        j += E.lVer; //adjusting for the right hand vertices
+        if (i == j)
+            continue;
+        E.left.push_back(i - 1);
+        E.right.push_back(j - 1);
+        E.weight.push_back(f);
+    }
+    return true;
+}
+
+// Little-endian records of a u32 left id, a u32 right id and an f32 weight,
+// with 0-based ids. Every edge is stored from both sides, as for a
+// symmetric matrix.
+static bool readEdgeList(TokenReader& in, const char* filename, EdgeInput& E) {
+    struct Record {
+        uint32_t src, dst;
+        float weight;
+    };
+    static_assert(sizeof(Record) == 12, "edge list records are 12 bytes");
+    cout << "Binary edge list" << endl;
+
+    vector<Record> block(1 << 16);
+    uint32_t maxSrc = 0, maxDst = 0;
+    size_t n;
+    while ((n = in.read((char*) block.data(), block.size() * sizeof(Record))) > 0) {
+        if (n % sizeof(Record) != 0) {
+            cerr << "Error: " << filename << " ends inside an edge record" << endl;
+            return false;
+        }
+        for (size_t k = 0; k < n / sizeof(Record); k++) {
+            const Record& r = block[k];
+            if (r.src >= INT_MAX || r.dst >= INT_MAX) {
+                cerr << "Error: edge (" << r.src << ", " << r.dst << ") of " << filename << " is out of range" << endl;
+                return false;
             }
-            if (offset > max)
-                max = offset;
+            maxSrc = max(maxSrc, r.src + 1);
+            maxDst = max(maxDst, r.dst + 1);
+            E.left.push_back(r.src);
+            E.right.push_back(r.dst);
+            E.weight.push_back(r.weight);
         }
-        
-        assert(count == nEdge);
-        maxDeg = max;
-        avgDeg = (double) totalDeg / nVer;
     }
-    else return false;
+    if (E.left.empty()) {
+        cerr << "Error: " << filename << " is empty" << endl;
+        return false;
+    }
+    if ((uint64_t) maxSrc + maxDst > INT_MAX) {
+        cerr << "Error: " << filename << " has too many vertices" << endl;
+        return false;
+    }
+    E.lVer = maxSrc;
+    E.rVer = maxDst;
+    E.sym = true;
+    for (int& j : E.right) {
+        j += E.lVer;
+    }
+    return true;
+}
+
+bool CSR::readMtxB(char* filename, bool abs_value, bool verbose, Profiler* prof, bool one_sided, bool random_weights) {
+    ByteStream* in = ByteStream::open(filename);
+    if (in == NULL)
+        return false;
+    if (verbose)
+        cout << "Reading " << filename << " (" << in->format() << ")" << endl;
+
+    if (prof) prof->begin("Parse");
+    EdgeInput E;
+    bool ok;
+    {
+        TokenReader reader(in);
+        ok = reader.startsWithComment() ? readMatrixMarket(reader, filename, E, random_weights) : readEdgeList(reader, filename, E);
+    }
+    if (ok && in->failed()) {
+        cerr << "Error: " << filename << " is corrupt or truncated" << endl;
+        ok = false;
+    }
+    delete in;
+    if (prof) prof->end();
+    if (!ok)
+        return false;
+
+    if (prof) prof->begin("CSR Build");
+    lVer = E.lVer;
+    rVer = E.rVer;
+    nVer = lVer + rVer;
+    oneSided = E.sym && one_sided;
+    pattern = E.pattern;
+    bool mirror = E.sym && !one_sided;
+    size_t entries = E.left.size();
+    nEdge = mirror ? 2*entries : entries;
+
+    // Counting sort by row; entries keep their input order within a row
+    vector<int> rowDeg(nVer, 0), rightDeg(nVer, 0);
+    for (size_t k = 0; k < entries; k++) {
+        rowDeg[E.left[k]]++;
+        if (mirror)
+            rowDeg[E.right[k]]++;
+        else if (oneSided)
+            rightDeg[E.right[k]]++;
+    }
+
+    verPtr = new int[nVer+1];
+    verInd = new Edge[nEdge];
+    verPtr[0] = 0;
+    int max = 0;
+    long totalDeg = 0;
+    for (int i = 0; i < nVer; i++) {
+        verPtr[i+1] = verPtr[i] + rowDeg[i];
+        totalDeg += rowDeg[i] + rightDeg[i];
+        max = std::max(max, std::max(rowDeg[i], rightDeg[i]));
+    }
+
+    vector<int> next(verPtr, verPtr + nVer);
+    maxWeight = 0;
+    for (size_t k = 0; k < entries; k++) {
+        float w = abs_value ? abs(E.weight[k]) : E.weight[k];
+        maxWeight = std::max(maxWeight, w);
+        verInd[next[E.left[k]]++] = Edge(E.right[k], w);
+        if (mirror)
+            verInd[next[E.right[k]]++] = Edge(E.left[k], w);
+    }
+
+    assert(verPtr[nVer] == nEdge);
+    maxDeg = max;
+    avgDeg = (double) totalDeg / nVer;
+    if (prof) prof->end();
 
     int flag = 0;
     for (int i = 0; i < lVer; i++) {    
-        for (j = verPtr[i]; j < verPtr[i+1]; j++) {
+        for (int j = verPtr[i]; j < verPtr[i+1]; j++) {
             if (verInd[j].id < lVer) {    
                 flag = 1;
                 break;
@@ -146,7 +313,7 @@ bool CSR::readMtxB(char* filename, bool abs_value, bool verbose) {
 
     flag = 0;
     for (int i = lVer; i < nVer; i++) {    
-        for (j = verPtr[i]; j< verPtr[i+1]; j++) {
+        for (int j = verPtr[i]; j< verPtr[i+1]; j++) {
             if (verInd[j].id >= lVer) {    
                 flag = 1;
                 break;
@@ -159,4 +326,144 @@ bool CSR::readMtxB(char* filename, bool abs_value, bool verbose) {
     }
     
     return true;
-}
\ No newline at end of file
+}
+
+bool CSR::sortByWeight() {
+    if (packed != NULL) {
+        cerr << "Error: can't sort the rows of a packed graph" << endl;
+        return false;
+    }
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int i = 0; i < nVer; i++) {
+        sort(verInd + verPtr[i], verInd + verPtr[i+1], [](const Edge& a, const Edge& b) {
+            return (a.weight > b.weight) || (a.weight == b.weight && a.id < b.id);
+        });
+    }
+    weightSorted = true;
+    return true;
+}
+
+bool CSR::buildRightRows() {
+    if (!oneSided)
+        return true;
+    if (packed != NULL) {
+        cerr << "Error: can't build the right-side rows of a packed graph" << endl;
+        return false;
+    }
+
+    int* ptr = new int[nVer+1];
+    Edge* ind = new Edge[2 * (long) nEdge];
+    vector<int> fill(nVer + 1, 0);
+    for (int j = 0; j < verPtr[lVer]; j++) {
+        fill[verInd[j].id + 1]++;
+    }
+    ptr[0] = 0;
+    for (int v = 0; v < nVer; v++) {
+        int deg = (v < lVer) ? verPtr[v+1] - verPtr[v] : fill[v+1];
+        ptr[v+1] = ptr[v] + deg;
+    }
+    memcpy(ind, verInd, verPtr[lVer] * sizeof(Edge));
+    for (int v = lVer; v < nVer; v++) {
+        fill[v] = ptr[v];
+    }
+    // Scanning the left rows in order leaves every right row sorted by id
+    for (int i = 0; i < lVer; i++) {
+        for (int j = verPtr[i]; j < verPtr[i+1]; j++) {
+            ind[fill[verInd[j].id]++] = Edge(i, verInd[j].weight);
+        }
+    }
+
+    delete [] verPtr;
+    delete [] verInd;
+    verPtr = ptr;
+    verInd = ind;
+    nEdge = ptr[nVer];
+    oneSided = false;
+    if (weightSorted)
+        sortByWeight();
+    return true;
+}
+
+static inline unsigned zigzag(int delta) {
+    return ((unsigned) delta << 1) ^ (unsigned) (delta >> 31);
+}
+
+static inline int varintBytes(unsigned v) {
+    int n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        n++;
+    }
+    return n;
+}
+
+void CSR::pack(bool quantize) {
+    dropPacked();
+    PackedRows* P = new PackedRows();
+    P->quantized = quantize;
+    P->bytePtr.assign(lVer + 1, 0);
+
+    // Size every row, then encode the rows in parallel at their offsets
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int i = 0; i < lVer; i++) {
+        long bytes = 0;
+        int prev = lVer;
+        for (int j = verPtr[i]; j < verPtr[i+1]; j++) {
+            bytes += varintBytes(zigzag(verInd[j].id - prev));
+            prev = verInd[j].id;
+        }
+        P->bytePtr[i+1] = bytes;
+    }
+    for (int i = 0; i < lVer; i++) {
+        P->bytePtr[i+1] += P->bytePtr[i];
+    }
+
+    int nLeft = verPtr[lVer];
+    P->ids.resize(P->bytePtr[lVer]);
+    if (quantize) {
+        P->scale = (maxWeight > 0) ? maxWeight / (PackedRows::negativeWeight - 1) : 1;
+        P->qweights.resize(nLeft);
+    }
+    else {
+        P->weights.resize(nLeft);
+    }
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int i = 0; i < lVer; i++) {
+        unsigned char* p = P->ids.data() + P->bytePtr[i];
+        int prev = lVer;
+        for (int j = verPtr[i]; j < verPtr[i+1]; j++) {
+            unsigned v = zigzag(verInd[j].id - prev);
+            prev = verInd[j].id;
+            while (v >= 0x80) {
+                *p++ = (unsigned char) (v | 0x80);
+                v >>= 7;
+            }
+            *p++ = (unsigned char) v;
+
+            float w = verInd[j].weight;
+            if (!quantize)
+                P->weights[j] = w;
+            else if (w < 0)
+                P->qweights[j] = PackedRows::negativeWeight;
+            else
+                P->qweights[j] = (uint16_t) min(lround(w / P->scale), (long) PackedRows::negativeWeight - 1);
+        }
+    }
+    packed = P;
+
+    // The packed rows replace verInd, and the right-side rows go with it
+    delete [] verInd;
+    verInd = NULL;
+    for (int i = lVer; i < nVer; i++) {
+        verPtr[i+1] = nLeft;
+    }
+    nEdge = nLeft;
+    oneSided = true;
+}
+
+void CSR::dropPacked() {
+    if (packed != NULL)
+        delete packed;
+    packed = NULL;
+}
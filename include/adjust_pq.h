@@ -30,13 +30,16 @@ class LowerPriorityThan {
   Comparator* compare_;
 };
 
-template <typename T, typename Comp = std::less<T> >
+template <typename T, typename Comp = std::less<T>,
+          typename Alloc = std::allocator<T*> >
 class AdjustablePriorityQueue {
  public:
   // The objects references 'c' and 'm' are not required to be alive for the
   // lifetime of this object.
   AdjustablePriorityQueue() {}
   AdjustablePriorityQueue(const Comp& c) : c_(c) {}
+  // The heap storage is obtained from 'a'.
+  explicit AdjustablePriorityQueue(const Alloc& a) : elems_(a) {}
   AdjustablePriorityQueue(const AdjustablePriorityQueue&) = delete;
   AdjustablePriorityQueue& operator=(const AdjustablePriorityQueue&) = delete;
   AdjustablePriorityQueue(AdjustablePriorityQueue&&) = default;
@@ -144,7 +147,12 @@ class AdjustablePriorityQueue {
   // This is for debugging, e.g. the caller can use it to
   // examine the heap for rationality w.r.t. other parts of the
   // program.
-  const std::vector<T*>* Raw() const { return &elems_; }
+  const std::vector<T*, Alloc>* Raw() const { return &elems_; }
+
+#ifdef AUCTION_STATS
+  // Number of element moves made by AdjustUpwards/AdjustDownwards.
+  long SiftSteps() const { return sift_steps_; }
+#endif
 
  private:
   void AdjustUpwards(int i) {
@@ -157,6 +165,9 @@ class AdjustablePriorityQueue {
       elems_[i] = elems_[parent];
       elems_[i]->SetHeapIndex(i);
       i = parent;
+#ifdef AUCTION_STATS
+      sift_steps_++;
+#endif
     }
     elems_[i] = t;
     t->SetHeapIndex(i);
@@ -180,13 +191,19 @@ class AdjustablePriorityQueue {
       elems_[i] = elems_[next_i];
       elems_[i]->SetHeapIndex(i);
       i = next_i;
+#ifdef AUCTION_STATS
+      sift_steps_++;
+#endif
     }
     elems_[i] = t;
     t->SetHeapIndex(i);
   }
 
   Comp c_;
-  std::vector<T*> elems_;
+  std::vector<T*, Alloc> elems_;
+#ifdef AUCTION_STATS
+  long sift_steps_ = 0;
+#endif
 };
 
 #endif  // ADJUST_PQ
\ No newline at end of file
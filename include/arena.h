@@ -0,0 +1,113 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <sys/mman.h>
+
+// Bump allocator for the auction state. The whole state of a solve is
+// carved out of one block sized up front, nothing is freed individually,
+// and reset() discards everything in O(1) so the block can be reused by the
+// next solve. Blocks of 2MB and more are mmap'ed and marked for transparent
+// huge pages.
+class Arena {
+    public:
+    static const size_t hugePage = 2 << 20;
+
+    Arena() : base(NULL), capacity(0), offset(0), mapped(false) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena() { release(); }
+
+    // Makes room for at least bytes, dropping everything allocated so far.
+    void reserve(size_t bytes) {
+        offset = 0;
+        if (bytes <= capacity)
+            return;
+        release();
+        if (bytes >= hugePage) {
+            size_t len = (bytes + hugePage - 1) / hugePage * hugePage;
+            void* p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p != MAP_FAILED) {
+#ifdef MADV_HUGEPAGE
+                madvise(p, len, MADV_HUGEPAGE);
+#endif
+                base = (char*) p;
+                capacity = len;
+                mapped = true;
+                return;
+            }
+        }
+        base = (char*) malloc(bytes);
+        if (base == NULL)
+            throw std::bad_alloc();
+        capacity = bytes;
+        mapped = false;
+    }
+
+    void reset() { offset = 0; }
+
+    void* allocate(size_t bytes, size_t align) {
+        size_t start = (offset + align - 1) & ~(align - 1);
+        if (start + bytes > capacity)
+            throw std::bad_alloc();
+        offset = start + bytes;
+        return base + start;
+    }
+
+    // Uninitialized storage for n objects of type T
+    template <typename T>
+    T* allocate(size_t n) { return (T*) allocate(n * sizeof(T), alignof(T)); }
+
+    size_t used() const { return offset; }
+
+    private:
+    char* base;
+    size_t capacity;
+    size_t offset;
+    bool mapped;
+
+    void release() {
+        if (base == NULL)
+            return;
+        if (mapped)
+            munmap(base, capacity);
+        else
+            free(base);
+        base = NULL;
+        capacity = 0;
+    }
+};
+
+// STL allocator drawing from an Arena; deallocation is a no-op. A default
+// constructed allocator has no arena and falls back to the global heap.
+template <typename T>
+struct ArenaAllocator {
+    typedef T value_type;
+
+    ArenaAllocator() : arena(NULL) {}
+    ArenaAllocator(Arena* arena) : arena(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        if (arena != NULL)
+            return arena->allocate<T>(n);
+        return (T*) ::operator new(n * sizeof(T));
+    }
+
+    void deallocate(T* p, size_t) {
+        if (arena == NULL)
+            ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+    Arena* arena;
+};
+
+#endif  //ARENA_H
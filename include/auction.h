@@ -3,25 +3,93 @@
 
 #include "graph.h"
 #include "adjust_pq.h"
+#include "scheduler.h"
+#include "arena.h"
+#include "checkpoint.h"
 #include <set>
+#include <atomic>
+#include <functional>
 #include <utility>
 #include <unordered_set>
 #include <set>
 #include <unordered_map>
 
+struct MatchedEdge {
+    MatchedEdge(int bidder, int object, float weight, float price)
+        : bidder(bidder), object(object), weight(weight), price(price) { }
 
-AlgResult bMatchingAuction(CSR* G, Node* S, double epsilon, bool verbose);
+    int bidder;
+    int object;
+    float weight;
+    float price;    // Price of the object copy held by the bidder
+};
+
+// Final state of an auction
+struct AuctionOutput {
+    vector<MatchedEdge> matching;
+    vector<float> prices;   // Lowest copy price of each object, indexed by id - lVer
+};
+
+// State of a b-matching auction reported while it bids, see AuctionOptions
+struct AuctionProgress {
+    double time;            // Seconds of bidding so far
+    long rounds;            // Bid rounds so far
+    double weight;          // Weight of the current matching, which is always a feasible b-matching
+    double bound;           // Dual upper bound on the optimal weight at the current prices
+    long unsaturated;       // Bidders waiting to bid
+};
+
+// Optional knobs for the auction algorithms. The defaults reproduce the
+// plain algorithm.
+struct AuctionOptions {
+    Profiler* prof = NULL;  // Records the Init/Bidding/Weight Sum phases when set
+    int cache_slack = 0;    // Candidates cached per bidder beyond b+1, 0 disables the cache
+    SchedulePolicy schedule = SCHEDULE_FIFO;   // Order in which unsaturated bidders are visited
+    AuctionOutput* out = NULL;  // Receives the matching and prices when set
+    Arena* arena = NULL;        // Holds the auction state; reset by every solve. A private arena is used if NULL
+    const char* checkpoint_file = NULL;     // Snapshots the state to this file while bidding when set
+    double checkpoint_interval = 60;        // Seconds between snapshots
+    const char* resume_file = NULL;         // Starts from this snapshot instead of the initial state when set
+    const vector<float>* warm_prices = NULL;    // Starting price of each object, indexed by id - lVer, instead of 0
+
+    // Anytime limits of the b-matching auction. When one is reached the
+    // auction stops and returns the heaviest matching it has held, with
+    // AlgResult::interrupted set.
+    double deadline = 0;    // Seconds of bidding, 0 for no limit
+    long bid_budget = 0;    // Bid rounds, 0 for no limit
+    atomic<long>* shared_rounds = NULL;     // When set, bid_budget caps the rounds of all the solves counting here together
+    function<void(const AuctionProgress&)> progress;   // Called every progress_interval seconds while bidding when set
+    double progress_interval = 1;
+};
+
+AlgResult bMatchingAuction(CSR* G, Node* S, double epsilon, bool verbose, const AuctionOptions& aopts = AuctionOptions());
 
-AlgResult bFactorAuction(CSR* G, Node* S, double epsilon, bool verbose);
+AlgResult bFactorAuction(CSR* G, Node* S, double epsilon, bool verbose, const AuctionOptions& aopts = AuctionOptions());
+
+// Upper bound on the weight of any b-matching from the dual of its LP
+// relaxation at the given object prices (FLT_MAX for objects with b = 0):
+// every object is charged b times its price and every bidder the sum of its
+// b most valuable edges at those prices. Prices are clamped at 0, so any
+// prices give a valid bound, and those of a running auction a tight one.
+double matchingDualBound(CSR* G, Node* S, const vector<float>& prices);
 
 vector<pair<float, Edge>> kBestObject(vector<pair<float, Edge>>& objs, int k);
 
+// Runs the auctions on one instance and keeps the matching and the object
+// prices of the last run.
 class Auction { 
     public:
         Auction(CSR* G, Node* S, double epsilon);
-        void bMatching(bool verbose);
-        void bFactor(bool verbose);
-        vector<Edge> getMatching();
+        AlgResult bMatching(bool verbose);
+        AlgResult bFactor(bool verbose);
+        const vector<MatchedEdge>& getMatching() const { return output.matching; }
+        const vector<float>& getPrices() const { return output.prices; }
+
+    private:
+        CSR* G;
+        Node* S;
+        double epsilon;
+        AuctionOutput output;
 };
 
 struct ObjectCopy {
@@ -45,16 +113,120 @@ struct ObjectCopy {
     }
 };
 
+struct MatchedSlot {
+    int first = -1;             // Object id, -1 if the slot is free
+    ObjectCopy* second = NULL;  // Copy of the object held by the bidder
+};
+
+// Objects held by a bidder, as an open addressing hash table on object ids
+// with linear probing. The slots come from the auction arena and number at
+// least twice the bidder's b-value, a power of two, so the table never
+// fills up.
+class MatchedSet {
+    public:
+    class iterator {
+        public:
+        iterator(MatchedSlot* p, MatchedSlot* end) : p(p), end(end) { skip(); }
+        MatchedSlot& operator*() const { return *p; }
+        iterator& operator++() { p++; skip(); return *this; }
+        bool operator!=(const iterator& o) const { return p != o.p; }
+
+        private:
+        MatchedSlot* p;
+        MatchedSlot* end;
+        void skip() { while (p != end && p->first < 0) p++; }
+    };
+
+    static int slotsFor(int b) {
+        int cap = 2;
+        while (cap < 2 * b)
+            cap <<= 1;
+        return cap;
+    }
+
+    void init(MatchedSlot* slots_, int capacity) {
+        slots = slots_;
+        mask = capacity - 1;
+        shift = 32;
+        for (int c = capacity; c > 1; c >>= 1)
+            shift--;
+        count = 0;
+        for (int k = 0; k < capacity; k++) {
+            slots[k] = MatchedSlot();
+        }
+    }
+
+    bool contains(int obj) const {
+        for (int k = hash(obj); slots[k].first >= 0; k = (k + 1) & mask) {
+            if (slots[k].first == obj)
+                return true;
+        }
+        return false;
+    }
+
+    void insert(int obj, ObjectCopy* c) {
+        int k = hash(obj);
+        while (slots[k].first >= 0 && slots[k].first != obj)
+            k = (k + 1) & mask;
+        if (slots[k].first < 0)
+            count++;
+        slots[k].first = obj;
+        slots[k].second = c;
+    }
+
+    // Backward shift deletion keeps every probe sequence free of holes
+    void erase(int obj) {
+        int k = hash(obj);
+        while (slots[k].first != obj) {
+            if (slots[k].first < 0)
+                return;
+            k = (k + 1) & mask;
+        }
+        count--;
+        int hole = k;
+        for (k = (k + 1) & mask; slots[k].first >= 0; k = (k + 1) & mask) {
+            int home = hash(slots[k].first);
+            if (((k - home) & mask) >= ((k - hole) & mask)) {
+                slots[hole] = slots[k];
+                hole = k;
+            }
+        }
+        slots[hole] = MatchedSlot();
+    }
+
+    int size() const { return count; }
+
+    iterator begin() const { return iterator(slots, slots + mask + 1); }
+    iterator end() const { return iterator(slots + mask + 1, slots + mask + 1); }
+
+    private:
+    MatchedSlot* slots = NULL;
+    int mask = 0;
+    int shift = 32;
+    int count = 0;
+
+    // Fibonacci hashing: the top bits of the product pick the slot
+    int hash(int obj) const { return (int) (((unsigned) obj * 2654435761u) >> shift); }
+};
+
 struct Bidder {
-    unordered_map<int, ObjectCopy*> matched;
-    //vector<BidderCopy> bidder_copies;
+    MatchedSet matched;
     bool is_strongly_eps_happy = false;
     bool permanent = false; // Used for b-Matching auction
+
+    // Candidate cache, see cachedBestObjects
+    pair<float, Edge>* cache = NULL;
+    int cache_size = 0;
+    float cache_bound = 0;
+    long cache_price_drops = -1;
 };
 
 struct Object {
-    vector<ObjectCopy> object_copies;
-    AdjustablePriorityQueue<ObjectCopy, greater<ObjectCopy>> pq;
+    Object(Arena* arena) : pq(ArenaAllocator<ObjectCopy*>(arena)) { }
+
+    ObjectCopy* object_copies = NULL;   // b copies, carved from the auction arena
+    int num_copies = 0;
+    AdjustablePriorityQueue<ObjectCopy, greater<ObjectCopy>, ArenaAllocator<ObjectCopy*>> pq;
 };
 
 #endif  //AUCTION_H
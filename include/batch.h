@@ -0,0 +1,23 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "graph.h"
+#include "arena.h"
+#include <functional>
+
+// Reads b-value scenarios from a text file with one scenario per line, each
+// holding nVer whitespace separated b-values in input vertex order. Blank
+// lines and lines starting with '%' or '#' are skipped.
+bool readScenarios(const char* filename, int nVer, vector<vector<int>>& scenarios);
+
+// Fills S with the b-values of one scenario, following G->origId if the
+// graph has been relabeled, and with the degree of every vertex.
+void scenarioNodes(CSR* G, const vector<int>& b, vector<Node>& S);
+
+// Solves every scenario on the shared, read-only graph G, concurrently over
+// the OpenMP threads. solve must not touch state shared between threads.
+// Each thread owns one arena that is handed to all of its solves, so the
+// auction state is allocated once per thread rather than once per scenario.
+vector<AlgResult> runBatch(CSR* G, const vector<vector<int>>& scenarios, const function<AlgResult(Node*, Arena*)>& solve);
+
+#endif  //BATCH_H
@@ -0,0 +1,84 @@
+#ifndef BIDDING_H
+#define BIDDING_H
+
+#include "graph.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// Steps of a b-matching bid shared by bMatchingAuction and the shard
+// workers, independent of where the prices and the held objects live.
+
+// Keeps in best, a min-heap on value, the k most valuable objects offered
+inline void offerBest(vector<pair<float, Edge>>& best, int k, float value, Edge e) {
+    greater<pair<float, Edge>> comp;
+    if (best.size() < k) {
+        best.push_back(make_pair(value, e));
+        push_heap(best.begin(), best.end(), comp);
+    }
+    else if (best.front().first < value) {
+        pop_heap(best.begin(), best.end(), comp);
+        best.back() = make_pair(value, e);
+        push_heap(best.begin(), best.end(), comp);
+    }
+}
+
+// Collects, in descending order of value, the (up to) k most valuable
+// neighbors of bidder whose value is at least min_value. value(e, v) sets v
+// to the value of edge e at the current prices, or returns false to skip
+// the object (held by the bidder, or without copies). If the rows of G are
+// sorted by descending weight the scan stops once no remaining edge can beat
+// the current k-th best value, since an object's value never exceeds the
+// edge weight. Returns the number of edges scanned.
+template <typename Row, typename Value>
+int scanBestObjects(CSR* G, int bidder, int k, double min_value, Value value, vector<pair<float, Edge>>& best) {
+    best.clear();
+    Row row(G, bidder);
+    Edge e;
+    int scanned = 0;
+    while (row.next(e)) {
+        if (G->weightSorted) {
+            if (e.weight < 0 || e.weight < min_value)
+                break;
+            if (best.size() == k && e.weight <= best.front().first)
+                break;
+        }
+        scanned++;
+        float v;
+        if (e.weight < 0 || !value(e, v) || v < min_value)
+            continue;
+        offerBest(best, k, v, e);
+    }
+    sort_heap(best.begin(), best.end(), greater<pair<float, Edge>>());
+    return scanned;
+}
+
+template <typename Value>
+int bestObjects(CSR* G, int bidder, int k, double min_value, Value value, vector<pair<float, Edge>>& best) {
+    if (G->packed)
+        return scanBestObjects<PackedRow>(G, bidder, k, min_value, value, best);
+    return scanBestObjects<PlainRow>(G, bidder, k, min_value, value, best);
+}
+
+// Takes the comparison object of a bid off the k best objects: the k-th, or
+// a stand-in worth epsilon if fewer than k objects are worth epsilon, in
+// which case the bidder becomes permanent, as losing a copy can't make it
+// bid higher.
+inline pair<float, Edge> takeComparison(vector<pair<float, Edge>>& best, int k, double epsilon, bool& permanent) {
+    if (best.size() < k) {
+        permanent = true;
+        return make_pair((float) epsilon, Edge(-1, 0));
+    }
+    pair<float, Edge> comparison = best.back();
+    best.pop_back();
+    return comparison;
+}
+
+// Raise of the price of an object worth value to the bidder, leaving it
+// epsilon above the comparison object
+inline float bidIncrement(float value, float comparison, double epsilon) {
+    return value - comparison + epsilon;
+}
+
+#endif  //BIDDING_H
@@ -0,0 +1,83 @@
+#ifndef BMATCHING_H
+#define BMATCHING_H
+
+/* C interface of libbmatching, built with "make lib".
+ *
+ * The graph is passed as the CSR of its rows (the bidders). Row i holds
+ * edges[row_ptr[i] .. row_ptr[i+1]), and edges[k].target is a column id
+ * offset by num_rows, i.e. column c is vertex num_rows + c. The edge array
+ * is read in place and never modified or freed, so it must stay valid for
+ * the duration of the call. b holds num_rows + num_cols b-values, rows
+ * first. Edges with negative weight are never matched. */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BM_API_VERSION 2
+
+/* Return codes */
+#define BM_FALLBACK         1   /* No perfect b-matching; solved by the b-matching auction as options->fallback asked */
+#define BM_OK               0
+#define BM_ERR_ARGS        -1   /* Invalid arguments */
+#define BM_ERR_CAPACITY    -2   /* The matching buffers are too small; result->num_matched holds the size needed */
+#define BM_ERR_INTERNAL    -3   /* Out of memory or another failure inside the solver */
+#define BM_ERR_INFEASIBLE  -4   /* BM_FACTOR only: the instance has no perfect b-matching */
+
+/* Algorithms */
+#define BM_MATCHING         1   /* b-matching auction */
+#define BM_FACTOR           0   /* perfect b-matching (b-factor) auction */
+
+/* Bidder visiting orders, see SchedulePolicy */
+#define BM_SCHEDULE_FIFO      0
+#define BM_SCHEDULE_LIFO      1
+#define BM_SCHEDULE_DEMAND    2
+#define BM_SCHEDULE_LOCALITY  3
+
+typedef struct {
+    int32_t target;
+    float weight;
+} bm_edge;
+
+typedef struct {
+    double epsilon;         /* Default 0.5 */
+    int32_t algorithm;      /* BM_MATCHING (default) or BM_FACTOR */
+    int32_t schedule;       /* BM_SCHEDULE_*, default BM_SCHEDULE_FIFO */
+    int32_t cache_slack;    /* Candidates cached per bidder beyond b+1, 0 (default) disables the cache */
+    int32_t decompose;      /* Solve connected components in parallel if nonzero */
+    int32_t prune_slack;    /* Solve on pruned edges if >= 0 (b-matching only), default -1 */
+    int32_t sorted;         /* Scan a copy of the rows sorted by weight if nonzero */
+    int32_t fallback;       /* BM_FACTOR: solve an instance without a perfect b-matching by the b-matching
+                               auction if nonzero, instead of failing with BM_ERR_INFEASIBLE; default 0 */
+} bm_options;
+
+typedef struct {
+    double weight;          /* Total weight of the matching */
+    double time;            /* Solve time in seconds */
+    int64_t num_matched;    /* Number of matched edges */
+} bm_result;
+
+/* Version of the interface the library implements, BM_API_VERSION */
+int bm_api_version(void);
+
+void bm_default_options(bm_options* options);
+
+/* Solves the instance. The i-th matched edge joins row match_rows[i] with
+ * column match_cols[i] (both 0-based) and has weight match_weights[i];
+ * the arrays must hold capacity entries. prices receives num_cols object
+ * prices, FLT_MAX for columns with b = 0; it may be NULL, as may
+ * match_weights. options may be NULL for the defaults. BM_FACTOR instances
+ * are first checked for a perfect b-matching, as the b-factor auction would
+ * bid forever without one. Returns BM_OK or BM_FALLBACK on success. */
+int bm_solve(int32_t num_rows, int32_t num_cols, const int32_t* row_ptr, const bm_edge* edges,
+             const int32_t* b, const bm_options* options,
+             int32_t* match_rows, int32_t* match_cols, float* match_weights, int64_t capacity,
+             float* prices, bm_result* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* BMATCHING_H */
@@ -0,0 +1,40 @@
+#ifndef BVALUES_H
+#define BVALUES_H
+
+#include "graph.h"
+#include <cstdint>
+
+// Counter-based generator: the value for (seed, counter) does not depend on
+// the order of the calls, so b-values can be drawn in parallel and are the
+// same for every thread count.
+inline uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Uniform integer in [lo, hi] for the given seed and counter
+inline int randomInRange(uint64_t seed, uint64_t counter, int lo, int hi) {
+    uint64_t r = splitmix64(seed ^ splitmix64(counter));
+    return lo + (int) (r % (uint64_t) (hi - lo + 1));
+}
+
+// Sets S[i].deg to the number of non-negative edges of every vertex
+void computeDegrees(CSR* G, Node* S);
+
+// b-values for the b-matching auction: uniform in [1, 10] for every vertex
+void randomBValues(CSR* G, Node* S, uint64_t seed);
+
+// b-values for the b-factor auction: each left vertex i gets b uniform in
+// [1, deg(i)/2] and shares it with a distinct random right vertex, so that
+// both sides have the same total. Right vertices left unpaired get b = 0.
+// Returns the total b-value of the left side.
+long randomBFactorValues(CSR* G, Node* S, uint64_t seed);
+
+// Reads one b-value per vertex, in input vertex order, into S. Files ending
+// in ".bin" hold nVer native int32 values; anything else is read as text
+// with whitespace separated integers.
+bool readBValues(const char* filename, CSR* G, Node* S);
+
+#endif  //BVALUES_H
@@ -0,0 +1,18 @@
+#ifndef CARDINALITY_H
+#define CARDINALITY_H
+
+#include "graph.h"
+#include "auction.h"
+
+// Maximum cardinality b-matching of a pattern input, where every edge weighs
+// 1 and the weighted auction would only fight price wars over ties. Solved
+// as a unit capacity max-flow (see FlowNetwork): a parallel greedy pass
+// seeds the flow, then Dinic phases with a parallel breadth-first search
+// augment it to a maximum. For the b-factor problem on a feasible instance
+// the result is a perfect b-matching. The prices written to aopts.out are 1
+// on the right side of a minimum cut and 0 elsewhere (FLT_MAX for objects
+// with b = 0), so matchingDualBound at those prices equals the weight.
+// Deadlines, bid budgets, progress reports and checkpoints don't apply.
+AlgResult cardinalityBMatching(CSR* G, Node* S, const AuctionOptions& aopts);
+
+#endif  //CARDINALITY_H
@@ -0,0 +1,93 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "graph.h"
+using namespace std;
+
+// Layout of a checkpoint file, in native byte order:
+//   CheckpointHeader
+//   CopyState[numCopies]       copies of every object, objects in id order
+//   char flags[numBidders]     BIDDER_HAPPY | BIDDER_PERMANENT
+//   int32 queue[numQueued]     unsaturated bidders in scheduler order
+struct CheckpointHeader {
+    char magic[8];          // "BMCKPT\0\1"
+    int32_t algorithm;      // 0 for the b-factor auction, 1 for the b-matching auction
+    int32_t reserved;
+    int64_t numVertices;
+    int64_t numBidders;
+    int64_t numCopies;
+    int64_t numQueued;
+    int64_t priceDrops;
+    uint64_t bHash;         // Hash of the b-values the state belongs to
+    double epsilon;
+};
+
+struct CopyState {
+    float price;
+    int32_t bidder;         // -1 while unsold
+    float weight;
+    int32_t heapIndex;      // Position in the object's queue, which breaks price ties
+};
+
+enum BidderFlags {
+    BIDDER_HAPPY = 1,
+    BIDDER_PERMANENT = 2
+};
+
+// State of an auction at one point between two bids
+struct AuctionSnapshot {
+    CheckpointHeader header;
+    vector<CopyState> copies;
+    vector<char> flags;
+    vector<int32_t> queue;
+};
+
+extern const char checkpointMagic[8];
+
+// Hash of the b-values, stored so that a checkpoint is not resumed with
+// different ones
+uint64_t hashBValues(Node* S, int n);
+
+// Writes snapshots of a running auction every interval seconds. The state
+// is captured into one of two buffers by the bidding thread, which costs a
+// copy of the object copies, and written by a background thread to a
+// temporary file that then replaces filename. A checkpoint falls due again
+// only once the previous write has finished, so bidding never waits on the
+// disk.
+class Checkpointer {
+    public:
+    Checkpointer(const string& filename, double interval);
+    ~Checkpointer();
+
+    // True if a snapshot should be taken now. Returns a free buffer in snap.
+    bool due(AuctionSnapshot*& snap);
+
+    // Starts writing the buffer returned by due()
+    void submit(AuctionSnapshot* snap);
+
+    // Waits for the write in progress, if any
+    void finish();
+
+    long written() const { return count; }
+
+    private:
+    string filename;
+    double interval;
+    double last;
+    AuctionSnapshot buffers[2];
+    int next;                   // Buffer to capture into
+    thread writer;
+    atomic<bool> busy;
+    atomic<long> count;
+};
+
+// Reads a checkpoint. Returns false if the file can't be read, is not a
+// checkpoint, or its size doesn't match the counts in its header.
+bool readCheckpoint(const char* filename, AuctionSnapshot& snap);
+
+#endif  //CHECKPOINT_H
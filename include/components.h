@@ -0,0 +1,33 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include "graph.h"
+#include "auction.h"
+
+// A connected component of the bipartite graph. vertices holds the ids of
+// the component in G, left vertices first, each side in ascending order.
+struct Component {
+    vector<int> vertices;
+    int lVer = 0;       // Number of left vertices in the component
+    long nEdge = 0;     // Number of left-side edges in the component
+};
+
+// Finds the connected components of G using union-find over the left-side
+// rows. Edges with negative weight are never matched and are ignored, and
+// components without an edge are dropped. Components are returned largest
+// (by edge count) first.
+vector<Component> findComponents(CSR* G);
+
+// Builds the subgraph of G induced by c, with c.vertices[v] becoming vertex
+// v of sub, and copies the matching b-values into subS. localId must map
+// every vertex of c to its position in c.vertices.
+void extractComponent(CSR* G, Node* S, const Component& c, const vector<int>& localId, CSR& sub, vector<Node>& subS);
+
+// Solves every connected component of G independently and sums the results.
+// Components are handed to OpenMP threads largest first, so one huge
+// component does not hold back the small ones. Runs the b-factor auction if
+// perfect is set and the b-matching auction otherwise. Prints the number of
+// components if verbose is set.
+AlgResult componentAuction(CSR* G, Node* S, double epsilon, bool perfect, bool verbose, const AuctionOptions& aopts);
+
+#endif  //COMPONENTS_H
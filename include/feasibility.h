@@ -0,0 +1,22 @@
+#ifndef FEASIBILITY_H
+#define FEASIBILITY_H
+
+#include "graph.h"
+
+// Outcome of checkBFactor
+struct FeasibilityReport {
+    long leftTotal = 0;         // Sum of the b-values of each side
+    long rightTotal = 0;
+    long maxEdges = -1;         // Size of a maximum b-matching, -1 if the degree check already failed
+    vector<int> deficient;      // Vertices whose b-value can't be met, in ascending order
+};
+
+// Checks whether G has a perfect b-matching (b-factor) using only edges of
+// non-negative weight, as the b-factor auction needs. A vertex with fewer
+// such neighbors of positive b-value than its own b-value fails the
+// parallel degree check, and is reported. Otherwise a maximum b-matching is
+// computed as a unit capacity max-flow (Dinic) and the vertices it leaves
+// short are reported. Returns true if the instance is feasible.
+bool checkBFactor(CSR* G, Node* S, FeasibilityReport& report);
+
+#endif  //FEASIBILITY_H
@@ -0,0 +1,47 @@
+#ifndef FLOW_H
+#define FLOW_H
+
+#include "graph.h"
+
+// Residual state of the network source -> left vertex (capacity b) -> right
+// vertex (capacity 1 per edge) -> sink (capacity b), whose maximum flows are
+// the maximum b-matchings of G. An edge is usable if its weight is >= 0, both
+// ends have b > 0 and it is the first edge between its two ends in the row,
+// as a bidder never holds the same object twice; allowed, if given, further
+// restricts them to the left-side edges it marks. Only the left-side rows of
+// G are read, once and through packed if built; the arcs back from a right
+// vertex are found through the list of edges into it.
+struct FlowNetwork {
+    CSR* G;
+    Node* S;
+    vector<char> usable;        // Per left-side edge
+    vector<char> flow;          // Per left-side edge
+    vector<int> rowOf;          // Left endpoint of each left-side edge
+    vector<int> col;            // Right endpoint of each left-side edge, minus lVer
+    vector<int> rightPtr;       // Edges into right vertex j are rightEdge[rightPtr[j] .. rightPtr[j+1])
+    vector<int> rightEdge;
+    vector<int> outL, inR;      // Flow through each vertex
+    vector<int> levL, levR;     // BFS levels, -1 if unreached or known to be a dead end
+    vector<int> itL, itR;       // Current arc of each vertex in this phase
+    int sinkLevel;
+
+    FlowNetwork(CSR* G, Node* S, const vector<char>* allowed = NULL);
+
+    // Adds flow along the usable edges of every left vertex, in parallel,
+    // while both ends have spare capacity. Returns the flow added.
+    long greedy();
+
+    // Builds the level graph of the next phase with a parallel breadth-first
+    // search from the left vertices with spare capacity. Returns false once
+    // the sink can't be reached, i.e. the flow is maximum; levR then marks
+    // the right vertices still reachable, the right side of a minimum cut.
+    bool levels();
+
+    bool augment(int root, vector<int>& path, vector<int>& via);
+
+    // Augments along shortest paths (Dinic) until the flow is maximum.
+    // Returns the flow added.
+    long maxFlow();
+};
+
+#endif  //FLOW_H
@@ -11,6 +11,9 @@
 #include <string>
 #include <cassert>
 #include <cstdlib>
+#include "stats.h"
+#include "profile.h"
+#include "packed.h"
 using namespace std;
 
 struct EdgeE {
@@ -61,6 +64,13 @@ struct AlgResult {
     double total_time;
     double init_time;
     double weight;
+    bool interrupted = false;   // Stopped at a deadline or bid budget; the matching is feasible but not eps-optimal
+    double bound = 0;           // Dual upper bound on the optimal weight, set when interrupted
+    bool infeasible = false;    // The b-factor instance has no perfect b-matching and was not solved...
+    bool fallback = false;      // ...unless this is set, when the b-matching auction solved it instead
+#ifdef AUCTION_STATS
+    AuctionStats stats;
+#endif
 };
 
 class Node {
@@ -79,23 +89,80 @@ class CSR
     int nVer;       // number of vertices 
     int nEdge;      // number of edges
     int maxDeg;
+    float maxWeight;
+    double avgDeg;
     int* verPtr;    // vertex pointer array of size nVer+1
     Edge* verInd;   // Edge array
     int rVer;       // The number of vertices on right for bipartite graph;
     int lVer;       // The number of vertices on left for bipartite graph;
+    int* origId;    // Input id of each vertex after relabeling, NULL if never relabeled
+    bool weightSorted;  // Every row is sorted by descending weight
+    bool oneSided;      // Only left-side rows are stored, right-side rows are empty
+    bool pattern;       // Read from a pattern matrix: every edge weighs 1
+    PackedRows* packed; // Compressed left-side rows, replacing verInd; NULL if not built
     
-    bool readMtxB(char * filename, bool abs_value, bool verbose); // reading as a bipartite graph
+    // reading as a bipartite graph; with one_sided the right-side rows of a symmetric input are not stored,
+    // with random_weights the edges of a pattern matrix weigh drand48()*1000000 instead of 1
+    bool readMtxB(char * filename, bool abs_value, bool verbose, Profiler* prof = NULL, bool one_sided = false, bool random_weights = false);
+    bool sortByWeight();    // sorts every row by descending weight; false if packed
+    bool buildRightRows();  // fills in the right-side rows as the transpose of the left-side ones, if missing; false if packed
+    void pack(bool quantize);   // builds packed from the left-side rows and frees verInd; the rows are then only read through packed
+    void dropPacked();      // discards packed once the rows change
     
-    CSR():nVer(0),nEdge(0),verPtr(NULL),verInd(NULL){}
+    CSR():nVer(0),nEdge(0),verPtr(NULL),verInd(NULL),origId(NULL),weightSorted(false),oneSided(false),pattern(false),packed(NULL){}
     ~CSR()
     {
         if(verPtr!=NULL)
-            delete verPtr;
+            delete [] verPtr;
 
         if(verInd!=NULL)
-            delete verInd;
+            delete [] verInd;
+
+        if(origId!=NULL)
+            delete [] origId;
+
+        dropPacked();
+    }
+
+};
+
+// Readers over the row of a left vertex, from verInd or from the packed rows
+struct PlainRow {
+    PlainRow(CSR* G, int v) : p(G->verInd + G->verPtr[v]), end(G->verInd + G->verPtr[v+1]) { }
+
+    bool next(Edge& e) {
+        if (p == end)
+            return false;
+        e = *p++;
+        return true;
     }
 
+    const Edge* p;
+    const Edge* end;
 };
 
+struct PackedRow {
+    PackedRow(CSR* G, int v) : c(*G->packed, v, G->verPtr[v], G->lVer) { }
+
+    bool next(Edge& e) { return c.next(e.id, e.weight); }
+
+    PackedCursor c;
+};
+
+// Calls f(e) on each edge of the row of left vertex v, in order
+template <typename F>
+void forEachEdge(CSR* G, int v, F f) {
+    Edge e;
+    if (G->packed) {
+        PackedRow row(G, v);
+        while (row.next(e))
+            f(e);
+    }
+    else {
+        PlainRow row(G, v);
+        while (row.next(e))
+            f(e);
+    }
+}
+
 #endif //GRAPH_H
@@ -0,0 +1,42 @@
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include "graph.h"
+#include "arena.h"
+#include <cstdio>
+#include <functional>
+
+// One instance of a manifest
+struct ManifestEntry {
+    string graph;
+    string bvalues;     // Empty for random b-values
+};
+
+// Reads a manifest with one instance per line: a graph file, optionally
+// followed by a b-value file. Relative paths are taken from the directory
+// of the manifest. Blank lines and lines starting with '%' or '#' are
+// skipped.
+bool readManifest(const char* filename, vector<ManifestEntry>& entries);
+
+// Solves one instance with the auction state in arena. Called concurrently
+// from the OpenMP threads.
+typedef function<AlgResult(CSR* G, Node* S, Arena* arena)> ManifestSolver;
+
+struct ManifestOptions {
+    int lookahead = 4;      // Instances read ahead of the solvers
+    uint64_t seed = 0;      // Random b-values of instance k are drawn from seed + k
+    bool perfect = false;   // Draw random b-values for the b-factor auction
+    bool abs_value = false; // As for CSR::readMtxB
+    bool one_sided = false;
+    bool random_weights = false;
+};
+
+// Solves every instance of entries. A reader thread loads the graphs and
+// b-values in manifest order, at most lookahead instances ahead, while the
+// OpenMP threads take them in turn, each solving one instance at a time
+// with its own arena. One "index graph weight time status" line per
+// instance is written to out as soon as it is solved, so lines appear in
+// completion order. Returns the number of instances that could not be read.
+long runManifest(const vector<ManifestEntry>& entries, const ManifestOptions& mopts, FILE* out, const ManifestSolver& solve);
+
+#endif  //MANIFEST_H
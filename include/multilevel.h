@@ -0,0 +1,32 @@
+#ifndef MULTILEVEL_H
+#define MULTILEVEL_H
+
+#include "graph.h"
+#include "auction.h"
+
+// A coarser copy of a bipartite graph. Bidders whose heaviest edge goes to
+// the same object are merged in pairs, as are objects whose heaviest edge
+// comes from the same bidder. A merged vertex gets the sum of the b-values
+// of its members, and parallel edges are merged into one with their mean
+// weight. Only the left-side rows are stored.
+struct CoarseGraph {
+    CSR G;
+    vector<Node> S;
+    vector<int> map;    // Coarse vertex of every fine vertex
+};
+
+// Builds one coarser level of G. Returns false if merging would remove
+// fewer than a tenth of the vertices, in which case coarse is unusable.
+bool coarsenGraph(CSR* G, Node* S, CoarseGraph& coarse);
+
+// Coarsens G up to levels times, solves the coarsest graph with the
+// b-matching auction and then every finer level, down to G itself, starting
+// from the object prices of the level above, so the bidding on G starts
+// near equilibrium. G is solved with the b-factor auction if perfect is set;
+// the coarse levels always use the b-matching auction, as merging can make
+// a perfect b-matching impossible. Deadlines, bid budgets, progress reports
+// and checkpoints of aopts only apply to G. Prints the size and result of
+// every coarse level if verbose is set.
+AlgResult multilevelAuction(CSR* G, Node* S, double epsilon, int levels, bool perfect, bool verbose, const AuctionOptions& aopts);
+
+#endif  //MULTILEVEL_H
@@ -0,0 +1,33 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include "graph.h"
+
+enum NumaPolicy {
+    NUMA_NONE,          // Leave pages where they were first touched
+    NUMA_LOCAL,         // One block of left vertices per node, rows moved to their block's node
+    NUMA_INTERLEAVE     // Spread the pages of the graph round-robin over all nodes
+};
+
+// Parses "none", "local" or "interleave". Returns false on an unknown name.
+bool parseNumaPolicy(const char* name, NumaPolicy& policy);
+
+// Node that OpenMP thread t of nThreads is pinned to by pinThreads. Threads
+// are packed onto nodes in order, so thread blocks match vertex blocks.
+int threadNode(int t, int nThreads, int nodes);
+
+// Pins every OpenMP thread to the CPUs of its node. Returns false if the
+// affinity of some thread could not be set.
+bool pinThreads();
+
+// Splits the left vertices into one contiguous block per node, balanced by
+// edge count. blocks[k] is the first vertex of block k, blocks[nodes] = lVer.
+vector<int> numaBlocks(CSR* G, int nodes);
+
+// Moves the pages of verPtr, verInd and the packed rows of G according to
+// policy. Pages are migrated with mbind, so arrays already first-touched by
+// one thread are placed as well. Does nothing on a single node machine.
+// Returns false if the kernel refused to move the pages.
+bool placeGraph(CSR* G, NumaPolicy policy);
+
+#endif  //NUMA_H
@@ -0,0 +1,41 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include "graph.h"
+#include "auction.h"
+#include <cstdint>
+
+// Layout of the binary matching file, in native byte order:
+//   MatchingFileHeader
+//   MatchingRecord[numMatched]
+//   float prices[numObjects]       lowest copy price per column, FLT_MAX if b = 0
+// Vertex ids are the 0-based row (bidder) and column (object) of the input
+// file, so relabeling is undone. The file can be mapped and read in place.
+struct MatchingFileHeader {
+    char magic[8];          // "BMATCH\0\1"
+    int64_t numBidders;
+    int64_t numObjects;
+    int64_t numMatched;
+    double weight;
+};
+
+struct MatchingRecord {
+    int32_t bidder;
+    int32_t object;
+    float weight;
+    float price;            // Price of the copy held by the bidder
+};
+
+extern const char matchingMagic[8];
+
+// Fills the numMatched records and the numObjects prices of the binary
+// layout from out
+void fillMatching(CSR* G, const AuctionOutput& out, MatchingRecord* rec, float* prices);
+
+// Writes the matching and prices of out. Files ending in ".bin" get the
+// binary layout above, written through a memory mapped file if use_mmap is
+// set; anything else gets text, one "row column weight price" line (1-based)
+// per matched edge followed by one "column price" line per object.
+bool writeMatching(const char* filename, CSR* G, const AuctionOutput& out, double weight, bool use_mmap);
+
+#endif  //OUTPUT_H
@@ -0,0 +1,74 @@
+#ifndef PACKED_H
+#define PACKED_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+using namespace std;
+
+// Left-side rows of a CSR in a compressed layout for the bidder scan. The
+// neighbor ids of a row are stored as zigzag varints of the difference to
+// the previous id (the first one to lVer), so a row costs one or two bytes
+// per id instead of four. Weights are kept as floats, or quantized to 16
+// bits in steps of scale, which is lossy. Edge k of the row of vertex i is
+// entry verPtr[i] + k of the weight arrays.
+struct PackedRows {
+    static const uint16_t negativeWeight = 0xFFFF;  // Quantized code of any weight below 0
+
+    bool quantized = false;
+    float scale = 0;                // Weight of one quantization step
+    vector<long> bytePtr;           // Offset of each row in ids, size lVer+1
+    vector<unsigned char> ids;
+    vector<float> weights;          // Weights, unless quantized
+    vector<uint16_t> qweights;      // Quantized weights
+
+    size_t bytes() const {
+        return bytePtr.size() * sizeof(long) + ids.size() + weights.size() * sizeof(float)
+             + qweights.size() * sizeof(uint16_t);
+    }
+};
+
+// Decodes one packed row front to back.
+class PackedCursor {
+    public:
+    PackedCursor(const PackedRows& P, int row, int edgeBegin, int lVer)
+        : p(P.ids.data() + P.bytePtr[row]), end(P.ids.data() + P.bytePtr[row+1]), prev(lVer),
+          weights(P.quantized ? NULL : P.weights.data() + edgeBegin),
+          qweights(P.quantized ? P.qweights.data() + edgeBegin : NULL), scale(P.scale) { }
+
+    bool next(int& id, float& weight) {
+        if (p == end)
+            return false;
+        unsigned v = *p++;
+        if (v & 0x80) {
+            v &= 0x7f;
+            int shift = 7;
+            unsigned char byte;
+            do {
+                byte = *p++;
+                v |= (unsigned) (byte & 0x7f) << shift;
+                shift += 7;
+            } while (byte & 0x80);
+        }
+        prev += (int) (v >> 1) ^ -(int) (v & 1);
+        id = prev;
+        if (weights != NULL) {
+            weight = *weights++;
+        }
+        else {
+            uint16_t q = *qweights++;
+            weight = (q == PackedRows::negativeWeight) ? -1.0f : q * scale;
+        }
+        return true;
+    }
+
+    private:
+    const unsigned char* p;
+    const unsigned char* end;
+    int prev;
+    const float* weights;
+    const uint16_t* qweights;
+    float scale;
+};
+
+#endif  //PACKED_H
@@ -0,0 +1,47 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <string>
+#include <vector>
+using namespace std;
+
+// Wall-clock time (and, if requested, hardware counters) spent in one phase.
+struct PhaseSample {
+    PhaseSample(const string& name) : name(name), time(0), cycles(-1), cache_misses(-1), branch_misses(-1) { }
+
+    string name;
+    double time;
+    long long cycles;           // -1 when hardware counters are unavailable
+    long long cache_misses;
+    long long branch_misses;
+};
+
+// Records a flat list of named phases. Calls to begin() must be paired with
+// end(); phases do not nest. Hardware counters are read through
+// perf_event_open and count the calling process and the threads it spawns
+// after the profiler was created.
+class Profiler {
+    public:
+    Profiler(bool hw_counters);
+    ~Profiler();
+
+    void begin(const string& name);
+    void end();
+    void print();
+
+    bool hwEnabled() const { return hw; }
+
+    vector<PhaseSample> phases;
+
+    private:
+    static const int numCounters = 3;
+
+    bool hw;
+    int fds[numCounters];
+    long long start_counts[numCounters];
+    double start_time;
+
+    void readCounters(long long* counts);
+};
+
+#endif  //PROFILE_H
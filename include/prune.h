@@ -0,0 +1,25 @@
+#ifndef PRUNE_H
+#define PRUNE_H
+
+#include "graph.h"
+#include "auction.h"
+
+// Marks the left-side edges of G to keep: an edge survives if it is among
+// the b + slack heaviest edges of either endpoint. keep is indexed like
+// G->verInd; entries of right-side rows are always 0.
+void pruneEdges(CSR* G, Node* S, int slack, vector<char>& keep);
+
+// Builds the subgraph of G with the same vertices and only the kept left-side
+// edges. Right-side rows are rebuilt as the transpose of the kept edges.
+void buildPrunedCSR(CSR* G, const vector<char>& keep, CSR& sub);
+
+// Runs the b-matching auction on the pruned graph, then checks the final
+// prices against every pruned edge. Edges that some bidder would rather bid
+// on than its current objects (eps-complementary slackness is violated) are
+// added back and the reduced problem is solved again until no violation is
+// left. The b-factor auction is not supported, since pruning can make a
+// feasible instance infeasible. Prints the size of every round if verbose
+// is set.
+AlgResult prunedAuction(CSR* G, Node* S, double epsilon, int slack, bool verbose, const AuctionOptions& aopts);
+
+#endif  //PRUNE_H
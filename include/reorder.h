@@ -0,0 +1,29 @@
+#ifndef REORDER_H
+#define REORDER_H
+
+#include "graph.h"
+
+enum ReorderMethod {
+    REORDER_NONE,
+    REORDER_DEGREE,     // Descending degree on each side
+    REORDER_RCM         // Reverse Cuthill-McKee over the bipartite graph
+};
+
+// Parses "none", "degree" or "rcm". Returns false on an unknown name.
+bool parseReorderMethod(const char* name, ReorderMethod& method);
+
+// Computes a relabeling of G. newToOld[v] is the original id of the vertex
+// that gets id v. Left vertices stay in [0, lVer) and right vertices in
+// [lVer, nVer), so the bipartition is preserved. RCM needs the right-side
+// rows and builds them if G is one-sided.
+vector<int> reorderPermutation(CSR* G, ReorderMethod method);
+
+// Relabels G in place according to newToOld and sorts every row by the new
+// neighbor ids, dropping any weight order. G->origId is updated so that
+// results can be mapped back to the ids of the input file.
+void permuteCSR(CSR* G, const vector<int>& newToOld);
+
+// Permutes the per-vertex data in S to match a permutation from reorderPermutation.
+void permuteNodes(Node* S, int n, const vector<int>& newToOld);
+
+#endif  //REORDER_H
@@ -0,0 +1,141 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <cstring>
+#include <deque>
+#include <queue>
+#include <utility>
+#include <vector>
+using namespace std;
+
+enum SchedulePolicy {
+    SCHEDULE_FIFO,      // Oldest unsaturated bidder first
+    SCHEDULE_LIFO,      // Most recently evicted bidder first
+    SCHEDULE_DEMAND,    // Bidder with the largest unmet b-value first
+    SCHEDULE_LOCALITY   // Drain one block of consecutive bidder ids at a time
+};
+
+// Parses "fifo", "lifo", "demand" or "locality". Returns false on an unknown name.
+inline bool parseSchedulePolicy(const char* name, SchedulePolicy& policy) {
+    if (strcmp(name, "fifo") == 0)
+        policy = SCHEDULE_FIFO;
+    else if (strcmp(name, "lifo") == 0)
+        policy = SCHEDULE_LIFO;
+    else if (strcmp(name, "demand") == 0)
+        policy = SCHEDULE_DEMAND;
+    else if (strcmp(name, "locality") == 0)
+        policy = SCHEDULE_LOCALITY;
+    else
+        return false;
+    return true;
+}
+
+// Work list of unsaturated bidders. A bidder is held at most once: pushing a
+// bidder that is already queued is a no-op, so evicting the same bidder from
+// several object copies does not fill the list with duplicates. Under the
+// demand policy it raises the bidder's key instead if its demand grew; the
+// outdated heap entry stays behind and is skipped when it surfaces.
+class BidderScheduler {
+    public:
+    static const int blockShift = 10;   // 1024 bidders per locality block
+
+    BidderScheduler(SchedulePolicy policy, int nBidders)
+        : policy(policy), queued(nBidders, 0), count(0), block(0) {
+        if (policy == SCHEDULE_LOCALITY)
+            blocks.resize((nBidders >> blockShift) + 1);
+        if (policy == SCHEDULE_DEMAND)
+            demandOf.resize(nBidders);
+    }
+
+    // Queues bidder, which still has demand unmatched copies to fill.
+    // Returns false if the bidder was already queued.
+    bool push(int bidder, int demand) {
+        if (queued[bidder]) {
+            if (policy == SCHEDULE_DEMAND && demand > demandOf[bidder]) {
+                demandOf[bidder] = demand;
+                byDemand.push(make_pair(demand, -bidder));
+            }
+            return false;
+        }
+        queued[bidder] = 1;
+        count++;
+        switch (policy) {
+            case SCHEDULE_FIFO:
+            case SCHEDULE_LIFO:         fifo.push_back(bidder);
+                                        break;
+            case SCHEDULE_DEMAND:       demandOf[bidder] = demand;
+                                        byDemand.push(make_pair(demand, -bidder));
+                                        break;
+            case SCHEDULE_LOCALITY:     blocks[bidder >> blockShift].push_back(bidder);
+                                        break;
+        }
+        return true;
+    }
+
+    int pop() {
+        int bidder = -1;
+        switch (policy) {
+            case SCHEDULE_FIFO:         bidder = fifo.front();
+                                        fifo.pop_front();
+                                        break;
+            case SCHEDULE_LIFO:         bidder = fifo.back();
+                                        fifo.pop_back();
+                                        break;
+            case SCHEDULE_DEMAND:       // Skip the entries of bidders popped or
+                                        // re-keyed since they were pushed
+                                        while (!queued[-byDemand.top().second]
+                                               || byDemand.top().first != demandOf[-byDemand.top().second])
+                                            byDemand.pop();
+                                        bidder = -byDemand.top().second;
+                                        byDemand.pop();
+                                        break;
+            case SCHEDULE_LOCALITY:     while (blocks[block].empty())
+                                            block = (block + 1) % blocks.size();
+                                        bidder = blocks[block].back();
+                                        blocks[block].pop_back();
+                                        break;
+        }
+        queued[bidder] = 0;
+        count--;
+        return bidder;
+    }
+
+    bool empty() const { return count == 0; }
+
+    // Queued bidders in the order they were pushed, so that pushing them
+    // into a new scheduler restores this one. Demand order is rebuilt from
+    // the demands given on push.
+    vector<int> contents() const {
+        vector<int> v;
+        v.reserve(count);
+        switch (policy) {
+            case SCHEDULE_FIFO:
+            case SCHEDULE_LIFO:         v.assign(fifo.begin(), fifo.end());
+                                        break;
+            case SCHEDULE_DEMAND:       for (int i = 0; i < queued.size(); i++) {
+                                            if (queued[i])
+                                                v.push_back(i);
+                                        }
+                                        break;
+            case SCHEDULE_LOCALITY:     for (auto& b : blocks) {
+                                            v.insert(v.end(), b.begin(), b.end());
+                                        }
+                                        break;
+        }
+        return v;
+    }
+
+    int size() const { return count; }
+
+    private:
+    SchedulePolicy policy;
+    vector<char> queued;                    // In-queue flag per bidder
+    int count;
+    deque<int> fifo;                        // FIFO and LIFO
+    priority_queue<pair<int, int>> byDemand;   // (demand, -bidder), possibly outdated
+    vector<int> demandOf;                   // Key of the current entry of each queued bidder
+    vector<vector<int>> blocks;             // Locality blocks
+    int block;                              // Block currently being drained
+};
+
+#endif  //SCHEDULER_H
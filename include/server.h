@@ -0,0 +1,62 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "graph.h"
+#include "auction.h"
+#include <cstdint>
+#include <functional>
+
+// Protocol of the solver daemon over a Unix domain stream socket, in native
+// byte order. A connection carries any number of requests, each answered
+// before the next one is read:
+//   request:   SolveRequest, int32 b[numBValues]      b-values in input vertex order
+//   response:  SolveResponse[, MatchingRecord[numMatched], float prices[numObjects]]
+// The matching and prices follow only for SOLVE_MATCHING requests that
+// succeeded (status >= 0), with the layout of the binary matching file. A
+// request with an unknown graph or the wrong number of b-values can't be
+// skipped, so the server answers it and closes the connection.
+struct SolveRequest {
+    char magic[4];          // "BMRQ"
+    int32_t graph;          // Index of the resident graph, in the order they were loaded
+    int32_t algorithm;      // 0 for the b-factor auction, 1 for the b-matching auction
+    int32_t flags;          // SolveFlags
+    double epsilon;
+    int64_t numBValues;     // Number of vertices of the graph
+};
+
+struct SolveResponse {
+    char magic[4];          // "BMRS"
+    int32_t status;         // ServerStatus
+    double weight;
+    double solveTime;       // Seconds spent in the solver
+    int64_t numMatched;
+    int64_t numObjects;
+};
+
+enum SolveFlags {
+    SOLVE_MATCHING = 1      // Return the matching and prices
+};
+
+enum ServerStatus {
+    SERVER_FALLBACK = 1,        // The b-factor instance is infeasible and was solved by the b-matching auction
+    SERVER_OK = 0,
+    SERVER_ERR_REQUEST = -1,    // Unknown graph or algorithm, bad epsilon or b-values
+    SERVER_ERR_INTERNAL = -2,   // The solver failed, e.g. out of memory
+    SERVER_ERR_INFEASIBLE = -3  // The b-factor instance has no perfect b-matching
+};
+
+extern const char solveRequestMagic[4];
+extern const char solveResponseMagic[4];
+
+// Solves one request. Called concurrently by the pool threads, each with its
+// own arena in aopts.
+typedef function<AlgResult(CSR* G, Node* S, int algorithm, double epsilon, const AuctionOptions& aopts)> ServerSolver;
+
+// Serves solve requests on the resident graphs at the socket path until
+// SIGINT or SIGTERM. Each of the pool threads serves one connection at a
+// time and runs its solves on omp_get_max_threads() / threads OpenMP
+// threads. Prints the throughput and latency percentiles on exit. Returns
+// false if the socket can't be created.
+bool runServer(const char* path, const vector<CSR*>& graphs, int threads, const AuctionOptions& aopts, const ServerSolver& solve);
+
+#endif  //SERVER_H
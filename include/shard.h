@@ -0,0 +1,28 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "graph.h"
+#include "auction.h"
+
+// Runs the b-matching auction in nWorkers forked processes. The left
+// vertices are split into contiguous blocks balanced by edge count, one per
+// worker, and each worker bids for its own block only. The object copies,
+// their prices and owners live in a shared memory segment; a copy changes
+// hands under a spin lock of its object, so prices are updated atomically
+// with respect to all workers. A bidder that loses a copy to another worker
+// is flagged in the segment and its owner is notified through a per-worker
+// mailbox counter. The workers stop once a shared count of outstanding
+// bidders drops to zero.
+//
+// Bidding follows bMatchingAuction, with the same scan and bid steps (see
+// bidding.h): a bidder takes its b+1-|held| best objects, raises every copy
+// it holds or takes to weight - comparison + epsilon, and becomes permanent
+// if fewer than k objects are worth epsilon.
+// Because workers bid concurrently, a bid whose copy was raised past the
+// bid in the meantime is dropped and the bidder bids again. The result is
+// still within the epsilon guarantee but can differ from the serial run.
+// The b-factor auction is not supported. Falls back to bMatchingAuction if
+// the segment or a worker can't be created, or a worker dies.
+AlgResult shardedAuction(CSR* G, Node* S, double epsilon, int nWorkers, const AuctionOptions& aopts);
+
+#endif  //SHARD_H
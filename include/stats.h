@@ -0,0 +1,84 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <iostream>
+#include <vector>
+using namespace std;
+
+// Hot-path counters for the auction loop. They are only compiled in when
+// building with -DAUCTION_STATS (see `make stats`); otherwise the STATS_*
+// macros expand to nothing and the auction compiles to the plain fast path.
+#ifdef AUCTION_STATS
+#define STATS_INC(st, field) ((st).field++)
+#define STATS_ADD(st, field, n) ((st).field += (n))
+#define STATS_DO(stmt) stmt
+#else
+#define STATS_INC(st, field)
+#define STATS_ADD(st, field, n)
+#define STATS_DO(stmt)
+#endif
+
+struct AuctionStats {
+    long bids = 0;              // Object copies won by a bid
+    long rebids = 0;            // Price raises on copies a bidder already held
+    long evictions = 0;         // Bidders displaced from an object copy
+    long queue_pushes = 0;      // Pushes onto the unsaturated bidder queue
+    long stale_pops = 0;        // Pops of bidders that were already happy
+    long edges_scanned = 0;     // Neighbor edges looked at while bidding
+    long sift_steps = 0;        // Heap moves in the objects' priority queues
+    long cache_hits = 0;        // Bidder visits answered by the candidate cache
+    long cache_misses = 0;      // Bidder visits that fell back to a full scan
+    vector<int> bid_rounds;     // Bidding rounds per bidder
+
+    // Accumulates the counters of another (independent) solve
+    void add(const AuctionStats& o) {
+        bids += o.bids;
+        rebids += o.rebids;
+        evictions += o.evictions;
+        queue_pushes += o.queue_pushes;
+        stale_pops += o.stale_pops;
+        edges_scanned += o.edges_scanned;
+        sift_steps += o.sift_steps;
+        cache_hits += o.cache_hits;
+        cache_misses += o.cache_misses;
+        bid_rounds.insert(bid_rounds.end(), o.bid_rounds.begin(), o.bid_rounds.end());
+    }
+
+    // Number of bidders whose bidding rounds fall in [2^(k-1), 2^k), with
+    // bucket 0 holding the bidders that never bid.
+    vector<long> roundHistogram() const {
+        vector<long> hist;
+        for (int r : bid_rounds) {
+            int k = 0;
+            while ((1 << k) <= r)
+                k++;
+            if (hist.size() <= k)
+                hist.resize(k+1, 0);
+            hist[k]++;
+        }
+        return hist;
+    }
+
+    void print() const {
+        cout << "\e[1mAuction Counters\e[0m" << endl;
+        cout << "Bids: " << bids << endl;
+        cout << "Rebids: " << rebids << endl;
+        cout << "Evictions: " << evictions << endl;
+        cout << "Queue Pushes: " << queue_pushes << endl;
+        cout << "Stale Pops: " << stale_pops << endl;
+        cout << "Edges Scanned: " << edges_scanned << endl;
+        cout << "Heap Sift Steps: " << sift_steps << endl;
+        cout << "Cache Hits/Misses: " << cache_hits << "/" << cache_misses << endl;
+        cout << "Bidding Rounds per Bidder: ";
+        vector<long> hist = roundHistogram();
+        for (int k = 0; k < hist.size(); k++) {
+            if (k == 0)
+                cout << "[0]: " << hist[k];
+            else
+                cout << " | [" << (1 << (k-1)) << ", " << (1 << k) << "): " << hist[k];
+        }
+        cout << endl << endl;
+    }
+};
+
+#endif  //STATS_H
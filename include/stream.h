@@ -0,0 +1,59 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+class Decoder;
+
+// Bytes of an input file, or of stdin for "-", read and decompressed on a
+// background thread into a small ring of chunks so that decompression
+// overlaps with the parsing done by the caller. gzip (also concatenated
+// members) and, when built with HAVE_ZSTD, zstd input are recognized by
+// their magic bytes, so compressed data can also arrive on stdin.
+class ByteStream {
+    public:
+    // Returns NULL, with a message, if the file can't be opened or is
+    // compressed with an unsupported format
+    static ByteStream* open(const char* filename);
+    ~ByteStream();
+
+    // Copies up to cap bytes to dst. Returns 0 at the end of the data or
+    // on an error, see failed().
+    size_t read(char* dst, size_t cap);
+
+    // True if reading or decompressing failed before the end of the data
+    bool failed() const { return error.load(); }
+
+    const char* format() const { return formatName; }
+
+    private:
+    struct Chunk {
+        vector<char> data;
+        size_t len = 0;
+    };
+
+    ByteStream(int fd, Decoder* decoder, const char* formatName);
+    void produce();
+
+    int fd;
+    Decoder* decoder;
+    const char* formatName;
+    Chunk chunks[4];
+    int head, tail;             // Next chunk to fill and next chunk to read
+    int filled;                 // Chunks ready to be read
+    size_t offset;              // Read position in chunks[tail]
+    bool done;                  // The producer has queued its last chunk
+    bool stopping;
+    atomic<bool> error;
+    mutex lock;
+    condition_variable changed;
+    thread producer;
+};
+
+#endif  //STREAM_H
@@ -1,6 +1,19 @@
 #include "include/graph.h"
 #include "include/auction.h"
 #include "include/comparison.h"
+#include "include/reorder.h"
+#include "include/components.h"
+#include "include/prune.h"
+#include "include/batch.h"
+#include "include/bvalues.h"
+#include "include/numa.h"
+#include "include/shard.h"
+#include "include/output.h"
+#include "include/server.h"
+#include "include/feasibility.h"
+#include "include/manifest.h"
+#include "include/multilevel.h"
+#include "include/cardinality.h"
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
@@ -18,10 +31,42 @@ using namespace std;
 
 struct auction_parameters {
     char* problem_name;
+    vector<char*> graph_files;  // Every -f file, resident in daemon mode
+    char* daemon_socket;
+    int jobs;
+    char* batch_file;
+    char* manifest_file;
+    char* bvalue_file;
+    char* output_file;
+    char* checkpoint_file;
+    double checkpoint_interval;
+    char* resume_file;
+    bool mmap_output;
+    uint64_t seed;
+    bool has_seed;
     bool verbose;
     bool abs_value;
     bool compare;
+    bool timers;
+    bool hw_counters;
     double epsilon;
+    ReorderMethod reorder;
+    bool sorted;
+    int cache_slack;
+    SchedulePolicy schedule;
+    bool decompose;
+    bool one_sided;
+    bool random_weights;    // Give pattern inputs random weights and solve them with the auction
+    NumaPolicy numa;
+    int compress;   // 0 for plain rows, 1 for varint ids, 2 for varint ids and 16-bit weights
+    int prune_slack;
+    int levels;     // Coarsening levels that warm-start the prices, 0 for none
+    int workers;
+    double deadline;
+    long bid_budget;
+    double progress_interval;   // 0 if progress is not reported
+    bool check_feasible;        // Check b-factor instances for a perfect b-matching before the auction
+    bool fallback;              // Solve infeasible b-factor instances with the b-matching auction
     int algorithm; //  0 for b-factor auction, 1 for b-matching auction, 2 for multiplicative b-matching auction
 
     auction_parameters();
@@ -29,18 +74,60 @@ struct auction_parameters {
     bool parse(int argc, char** argv);
 };
 
-auction_parameters::auction_parameters():problem_name(NULL),algorithm(1),abs_value(false),verbose(false),compare(false),epsilon(0.5){}
+auction_parameters::auction_parameters():problem_name(NULL),daemon_socket(NULL),jobs(0),batch_file(NULL),manifest_file(NULL),bvalue_file(NULL),output_file(NULL),checkpoint_file(NULL),checkpoint_interval(60),resume_file(NULL),mmap_output(false),seed(0),has_seed(false),algorithm(1),abs_value(false),verbose(false),compare(false),timers(false),hw_counters(false),epsilon(0.5),reorder(REORDER_NONE),sorted(false),cache_slack(0),schedule(SCHEDULE_FIFO),decompose(false),one_sided(false),random_weights(false),numa(NUMA_NONE),compress(0),prune_slack(-1),levels(0),workers(0),deadline(0),bid_budget(0),progress_interval(0),check_feasible(true),fallback(false){}
 
 void auction_parameters::usage() {
     const char *params =
 	"\n"
     "Usage: %s -f <problem_name> [-e <value>] [-p] [-a] [-v]\n\n"
-	"   -f --filename problem_name  : File containing graph. Currently inputs .mtx files\n"
+	"   -f --filename problem_name  : File containing graph: .mtx, or a binary edge list of (u32, u32, f32) records.\n"
+    "                                 Either may be gzip (or zstd) compressed; - reads stdin\n"
     "   -e --epsilon  value         : Value for epsilon. Default is ε=0.5\n"
+    "   -b --batch    file          : Solve every b-value scenario in file (one per line) on the loaded graph\n"
+    "   -D --daemon   socket        : Keep the graphs resident and serve solve requests on a Unix domain socket.\n"
+    "                                 -f may be repeated to load several graphs\n"
+    "   -j --jobs     n             : Number of requests the daemon solves concurrently. Default is one per thread\n"
+    "   -L --manifest file          : Solve every instance listed in file (a graph and optionally a b-value file per\n"
+    "                                 line) concurrently, writing one result line per instance to -O or stdout\n"
+    "   -B --bvalues  file          : Read the b-values from file (text, or int32 binary if it ends in .bin)\n"
+    "   -O --output   file          : Write the matching and prices to file (text, or binary if it ends in .bin)\n"
+    "   -M --mmap                   : Write the binary output through a memory mapped file\n"
+    "   -C --checkpoint file        : Snapshot the auction state to file while bidding\n"
+    "   -I --interval seconds       : Seconds between snapshots. Default is 60\n"
+    "   -R --resume   file          : Resume the auction from a snapshot of the same instance\n"
+    "   -S --seed     value         : Seed for the random b-values. Default is a random seed, which is printed\n"
+    "   -r --reorder  method        : Relabel vertices for locality: none (default), degree or rcm\n"
+    "   -s --sorted                 : Sort adjacency by descending weight so bidders can stop scanning early\n"
+    "   -k --cache    n             : Cache the b+1+n best candidates of each bidder between visits. Default is 0 (off)\n"
+    "   -q --queue    policy        : Bidder visiting order: fifo (default), lifo, demand or locality\n"
+    "   -d --decompose              : Solve each connected component separately, in parallel\n"
+    "   -o --one-sided              : Store only the left-side rows of a symmetric input, halving the graph\n"
+    "   -W --random-weights         : Weigh the edges of pattern inputs randomly and run the auction. By default\n"
+    "                                 they weigh 1 and a maximum cardinality b-matching is computed by max-flow\n"
+    "   -z --compress mode          : Scan compressed rows: varint (delta coded ids) or quant16 (also 16-bit\n"
+    "                                 quantized weights, lossy). They replace the plain rows, so -l, -x, -d\n"
+    "                                 and -c are not available\n"
+    "   -N --numa     policy        : Pin threads to NUMA nodes and place the graph: none (default), local\n"
+    "                                 (left vertex blocks on their threads' nodes) or interleave\n"
+    "   -x --prune    slack         : Solve on the b+slack heaviest edges per vertex, re-adding edges until the\n"
+    "                                 prices prove optimality on the full graph (b-matching auction only)\n"
+    "   -l --levels   n             : Coarsen the graph up to n times and solve the levels from the coarsest down,\n"
+    "                                 each starting from the prices of the one above\n"
+    "   -w --workers  n             : Split the bidders over n processes sharing the prices through shared\n"
+    "                                 memory (b-matching auction only)\n"
+    "   -T --deadline seconds       : Stop bidding after this many seconds and return the heaviest matching held so\n"
+    "                                 far, with a dual upper bound on the optimum (b-matching auction only)\n"
+    "   -u --budget   rounds        : Stop after this many bid rounds, as for -T\n"
+    "   -g --progress seconds       : Report the matching weight and dual bound at this interval while bidding\n"
     "   -p --perfect                : Use the perfect b-matching (b-factor) auction algorithm\n"
+    "   -F --fallback               : Solve b-factor instances without a perfect b-matching with the b-matching\n"
+    "                                 auction instead of stopping\n"
+    "   -K --no-check               : Skip the b-factor feasibility check\n"
     "   -m --multiplicative         : Use the multiplicative b-matching auction algorithm\n"
     "   -c --compare                : Perform a comparion against other algorithms\n"
     "   -a --absvalue               : Take the absolute value of edge weights\n"
+    "   -t --timers                 : Report the time spent in each phase\n"
+    "   -P --perf                   : Also read cycles, cache misses and branch misses per phase (implies -t)\n"
     "   -v --verbose                : Verbose \n\n"
     "By default this runs the b-matching auction algorithm. Use -p to run the b-factor auction algorihtm.\n\n";
     fprintf(stderr, params);
@@ -55,15 +142,45 @@ bool auction_parameters::parse(int argc, char** argv) {
         {"compare", no_argument, NULL, 'c'},
         {"perfect", no_argument, NULL, 'p'},
         {"multiplicative", no_argument, NULL, 'm'},
+        {"timers", no_argument, NULL, 't'},
+        {"perf", no_argument, NULL, 'P'},
+        {"sorted", no_argument, NULL, 's'},
+        {"decompose", no_argument, NULL, 'd'},
+        {"mmap", no_argument, NULL, 'M'},
+        {"one-sided", no_argument, NULL, 'o'},
+        {"fallback", no_argument, NULL, 'F'},
+        {"no-check", no_argument, NULL, 'K'},
+        {"random-weights", no_argument, NULL, 'W'},
         
         // These do
         {"filename", required_argument, NULL, 'f'},
         {"epsilon", required_argument, NULL, 'e'},
+        {"reorder", required_argument, NULL, 'r'},
+        {"cache", required_argument, NULL, 'k'},
+        {"queue", required_argument, NULL, 'q'},
+        {"prune", required_argument, NULL, 'x'},
+        {"levels", required_argument, NULL, 'l'},
+        {"batch", required_argument, NULL, 'b'},
+        {"manifest", required_argument, NULL, 'L'},
+        {"bvalues", required_argument, NULL, 'B'},
+        {"seed", required_argument, NULL, 'S'},
+        {"compress", required_argument, NULL, 'z'},
+        {"numa", required_argument, NULL, 'N'},
+        {"workers", required_argument, NULL, 'w'},
+        {"output", required_argument, NULL, 'O'},
+        {"checkpoint", required_argument, NULL, 'C'},
+        {"interval", required_argument, NULL, 'I'},
+        {"resume", required_argument, NULL, 'R'},
+        {"daemon", required_argument, NULL, 'D'},
+        {"jobs", required_argument, NULL, 'j'},
+        {"deadline", required_argument, NULL, 'T'},
+        {"budget", required_argument, NULL, 'u'},
+        {"progress", required_argument, NULL, 'g'},
 
         {NULL, no_argument, NULL, 0}
     };
 
-    static const char *opt_string = "vhacpf:e:";
+    static const char *opt_string = "vhacptPsdoMFKWf:e:r:k:q:x:l:b:B:S:z:N:w:O:C:I:R:D:j:T:u:g:L:";
     int opt, longindex;
     opt = getopt_long(argc,argv,opt_string,long_options,&longindex);
     while (opt != -1) {
@@ -87,7 +204,106 @@ bool auction_parameters::parse(int argc, char** argv) {
             case 'm':   algorithm = 2;
                         break;
 
+            case 't':   timers = true;
+                        break;
+
+            case 'P':   timers = true;
+                        hw_counters = true;
+                        break;
+
+            case 's':   sorted = true;
+                        break;
+
+            case 'd':   decompose = true;
+                        break;
+
+            case 'o':   one_sided = true;
+                        break;
+
+            case 'M':   mmap_output = true;
+                        break;
+
+            case 'F':   fallback = true;
+                        break;
+
+            case 'K':   check_feasible = false;
+                        break;
+
+            case 'W':   random_weights = true;
+                        break;
+
+            case 'O':   output_file = optarg;
+                        break;
+
+            case 'C':   checkpoint_file = optarg;
+                        break;
+
+            case 'I':   checkpoint_interval = atof(optarg);
+                        if (checkpoint_interval <= 0) {
+                            cerr << "Error: the checkpoint interval must be positive" << endl;
+                            return false;
+                        }
+                        break;
+
+            case 'R':   resume_file = optarg;
+                        break;
+
+            case 'D':   daemon_socket = optarg;
+                        break;
+
+            case 'j':   jobs = atoi(optarg);
+                        if (jobs < 1) {
+                            cerr << "Error: the number of jobs must be positive" << endl;
+                            return false;
+                        }
+                        break;
+
+            case 'T':   deadline = atof(optarg);
+                        if (deadline <= 0) {
+                            cerr << "Error: the deadline must be positive" << endl;
+                            return false;
+                        }
+                        break;
+
+            case 'u':   bid_budget = atol(optarg);
+                        if (bid_budget <= 0) {
+                            cerr << "Error: the bid budget must be positive" << endl;
+                            return false;
+                        }
+                        break;
+
+            case 'g':   progress_interval = atof(optarg);
+                        if (progress_interval <= 0) {
+                            cerr << "Error: the progress interval must be positive" << endl;
+                            return false;
+                        }
+                        break;
+
+            case 'w':   workers = atoi(optarg);
+                        if (workers < 1) {
+                            cerr << "Error: the number of workers must be positive" << endl;
+                            return false;
+                        }
+                        break;
+
+            case 'N':   if (!parseNumaPolicy(optarg, numa)) {
+                            cerr << "Error: unknown NUMA policy " << optarg << endl;
+                            return false;
+                        }
+                        break;
+
+            case 'z':   if (strcmp(optarg, "varint") == 0)
+                            compress = 1;
+                        else if (strcmp(optarg, "quant16") == 0)
+                            compress = 2;
+                        else {
+                            cerr << "Error: unknown compression mode " << optarg << endl;
+                            return false;
+                        }
+                        break;
+
             case 'f':   problem_name = optarg; 
+                        graph_files.push_back(optarg);
                         cout << "Problem file: " << problem_name << endl;
                         if (problem_name == NULL || problem_name[0] == '\0' || *problem_name == 0) {
                             cerr << "Error: Problem file is not speficied" << endl;
@@ -101,9 +317,61 @@ bool auction_parameters::parse(int argc, char** argv) {
                             return false;
                         }
                         break;
+
+            case 'k':   cache_slack = atoi(optarg);
+                        if (cache_slack < 0) {
+                            cerr << "Error: cache size can't be negative" << endl;
+                            return false;
+                        }
+                        break;
+
+            case 'b':   batch_file = optarg;
+                        break;
+
+            case 'L':   manifest_file = optarg;
+                        break;
+
+            case 'B':   bvalue_file = optarg;
+                        break;
+
+            case 'S':   seed = strtoull(optarg, NULL, 10);
+                        has_seed = true;
+                        break;
+
+            case 'x':   prune_slack = atoi(optarg);
+                        if (prune_slack < 0) {
+                            cerr << "Error: prune slack can't be negative" << endl;
+                            return false;
+                        }
+                        break;
+
+            case 'l':   levels = atoi(optarg);
+                        if (levels < 0) {
+                            cerr << "Error: the number of levels can't be negative" << endl;
+                            return false;
+                        }
+                        break;
+
+            case 'q':   if (!parseSchedulePolicy(optarg, schedule)) {
+                            cerr << "Error: unknown queue policy " << optarg << endl;
+                            return false;
+                        }
+                        break;
+
+            case 'r':   if (!parseReorderMethod(optarg, reorder)) {
+                            cerr << "Error: unknown reordering method " << optarg << endl;
+                            return false;
+                        }
+                        break;
         }
         opt = getopt_long(argc,argv,opt_string,long_options,&longindex);
     }
+
+    // The packed rows replace verInd, which these modes still read directly
+    if (compress > 0 && (levels > 0 || prune_slack >= 0 || decompose || compare)) {
+        cerr << "Error: compressed rows can't be combined with multilevel, pruned, decomposed or comparison runs" << endl;
+        return false;
+    }
     return true;
 }
 
@@ -120,6 +388,269 @@ void print_comparison_result(string alg, AlgResult res) {
     }
 }
 
+// Applies the requested graph preprocessing once the b-values are known.
+// S may be NULL if the b-values are looked up through G.origId later.
+void preprocess_graph(CSR& G, Node* S, auction_parameters& opts, Profiler* prof) {
+    if (opts.reorder != REORDER_NONE) {
+        if (prof) prof->begin("Reorder");
+        vector<int> newToOld = reorderPermutation(&G, opts.reorder);
+        permuteCSR(&G, newToOld);
+        if (S != NULL)
+            permuteNodes(S, G.nVer, newToOld);
+        if (prof) prof->end();
+    }
+
+    if (opts.sorted) {
+        if (prof) prof->begin("Weight Sort");
+        G.sortByWeight();
+        if (prof) prof->end();
+    }
+
+    if (opts.compress > 0) {
+        if (prof) prof->begin("Compress");
+        G.pack(opts.compress == 2);
+        if (prof) prof->end();
+        cout << "Compressed rows: " << G.packed->bytes() << " bytes (plain: "
+             << G.verPtr[G.lVer] * sizeof(Edge) << " bytes)" << endl << endl;
+    }
+
+    if (opts.numa != NUMA_NONE) {
+        if (prof) prof->begin("NUMA Placement");
+        if (!pinThreads())
+            cout << "Warning: could not pin threads to NUMA nodes" << endl;
+        if (!placeGraph(&G, opts.numa))
+            cout << "Warning: could not move the graph pages" << endl;
+        if (prof) prof->end();
+    }
+}
+
+// Writes the matching and prices of the last run if an output file was given
+bool write_output(CSR* G, auction_parameters& opts, const AuctionOptions& aopts, double weight, Profiler* prof) {
+    if (opts.output_file == NULL || aopts.out == NULL)
+        return true;
+    if (prof) prof->begin("Write Output");
+    bool ok = writeMatching(opts.output_file, G, *aopts.out, weight, opts.mmap_output);
+    if (prof) prof->end();
+    if (ok)
+        cout << "Matching written to " << opts.output_file << endl << endl;
+    return ok;
+}
+
+// Runs the auction variant selected by the command line options
+AlgResult run_auction(CSR* G, Node* S, auction_parameters& opts, const AuctionOptions& aopts, bool verbose) {
+    if (G->pattern)
+        return cardinalityBMatching(G, S, aopts);
+    if (opts.levels > 0)
+        return multilevelAuction(G, S, opts.epsilon, opts.levels, opts.algorithm == 0, verbose, aopts);
+    if (opts.algorithm == 0) {
+        if (opts.decompose)
+            return componentAuction(G, S, opts.epsilon, true, verbose, aopts);
+        return bFactorAuction(G, S, opts.epsilon, verbose, aopts);
+    }
+
+    if (opts.workers > 0)
+        return shardedAuction(G, S, opts.epsilon, opts.workers, aopts);
+    if (opts.prune_slack >= 0)
+        return prunedAuction(G, S, opts.epsilon, opts.prune_slack, verbose, aopts);
+    if (opts.decompose)
+        return componentAuction(G, S, opts.epsilon, false, verbose, aopts);
+    return bMatchingAuction(G, S, opts.epsilon, verbose, aopts);
+}
+
+// Lists the vertices that keep an instance from having a perfect b-matching
+void print_feasibility_report(CSR* G, Node* S, const FeasibilityReport& report) {
+    cout << "No perfect b-matching: the rows need " << report.leftTotal << " edges, the columns "
+         << report.rightTotal;
+    if (report.maxEdges >= 0)
+        cout << ", at most " << report.maxEdges << " can be matched";
+    cout << endl << "Deficient vertices: " << report.deficient.size() << endl;
+    for (int k = 0; k < report.deficient.size() && k < 10; k++) {
+        int v = report.deficient[k];
+        int id = (G->origId != NULL) ? G->origId[v] : v;
+        if (v < G->lVer)
+            cout << "  row " << id + 1;
+        else
+            cout << "  column " << id - G->lVer + 1;
+        cout << " (b = " << S[v].b << ")" << endl;
+    }
+    if (report.deficient.size() > 10)
+        cout << "  ..." << endl;
+    cout << endl;
+}
+
+// Runs run_auction, first checking that a b-factor instance has a perfect
+// b-matching. Infeasible instances are solved by the b-matching auction with
+// -F and returned unsolved otherwise.
+AlgResult run_checked_auction(CSR* G, Node* S, auction_parameters& opts, const AuctionOptions& aopts) {
+    if (opts.algorithm == 0 && opts.check_feasible) {
+        FeasibilityReport report;
+        if (!checkBFactor(G, S, report)) {
+            AlgResult res(0, 0, 0);
+            if (opts.fallback) {
+                auction_parameters matching_opts = opts;
+                matching_opts.algorithm = 1;
+                res = run_auction(G, S, matching_opts, aopts, false);
+                res.fallback = true;
+            }
+            res.infeasible = true;
+            return res;
+        }
+    }
+    return run_auction(G, S, opts, aopts, false);
+}
+
+// Solves all b-value scenarios of opts.batch_file on the resident graph
+int run_batch(CSR& G, auction_parameters& opts, AuctionOptions aopts, Profiler* prof) {
+    if (prof) prof->begin("Read Scenarios");
+    vector<vector<int>> scenarios;
+    bool ok = readScenarios(opts.batch_file, G.nVer, scenarios);
+    if (prof) prof->end();
+    if (!ok)
+        return -1;
+    cout << "Scenarios: " << scenarios.size() << endl << endl;
+
+    preprocess_graph(G, NULL, opts, prof);
+
+    // Solver state is private to each scenario; the profiler is not thread safe
+    aopts.prof = NULL;
+    if (aopts.out != NULL)
+        cerr << "Warning: matchings are not written in batch mode" << endl;
+    aopts.out = NULL;
+    aopts.progress = nullptr;
+    aopts.checkpoint_file = NULL;
+    aopts.resume_file = NULL;
+    double start = omp_get_wtime();
+    if (prof) prof->begin("Batch Solves");
+    vector<AlgResult> results = runBatch(&G, scenarios, [&](Node* S, Arena* arena) {
+        AuctionOptions thread_opts = aopts;
+        thread_opts.arena = arena;
+        return run_checked_auction(&G, S, opts, thread_opts);
+    });
+    if (prof) prof->end();
+    double elapsed = omp_get_wtime() - start;
+
+    for (int k = 0; k < results.size(); k++) {
+        if (results[k].infeasible && !results[k].fallback) {
+            cout << "Scenario " << k << ": no perfect b-matching" << endl;
+            continue;
+        }
+        cout << "Scenario " << k << ": Total Weight: " << results[k].weight
+             << ", Running Time: " << results[k].total_time;
+        if (results[k].fallback)
+            cout << " (b-matching auction, no perfect b-matching)";
+        cout << endl;
+    }
+    cout << endl << "Batch Time: " << elapsed << endl;
+    cout << "Throughput: " << results.size() / elapsed << " scenarios/s" << endl << endl;
+    return 0;
+}
+
+// Solves every instance of opts.manifest_file, each with its own graph
+int run_manifest(auction_parameters& opts) {
+    vector<ManifestEntry> entries;
+    if (!readManifest(opts.manifest_file, entries))
+        return -1;
+    if (opts.workers > 0) {
+        cerr << "Error: multi-process workers can't be combined with manifest mode" << endl;
+        return -1;
+    }
+    if (opts.batch_file || opts.bvalue_file || opts.checkpoint_file || opts.resume_file || opts.compare || opts.daemon_socket)
+        cerr << "Warning: batch, b-value, checkpoint, comparison and daemon options are ignored in manifest mode" << endl;
+    if (opts.numa != NUMA_NONE)
+        cerr << "Warning: NUMA placement is ignored in manifest mode" << endl;
+
+    FILE* out = stdout;
+    if (opts.output_file != NULL) {
+        out = fopen(opts.output_file, "w");
+        if (out == NULL) {
+            cerr << "Error: can't open " << opts.output_file << endl;
+            return -1;
+        }
+    }
+    if (!opts.has_seed) {
+        std::random_device rd;
+        opts.seed = ((uint64_t) rd() << 32) | rd();
+        cout << "Seed: " << opts.seed << endl << endl;
+    }
+
+    // Solver state is private to each instance; the profiler is not thread safe
+    AuctionOptions aopts;
+    aopts.cache_slack = opts.cache_slack;
+    aopts.schedule = opts.schedule;
+    aopts.deadline = opts.deadline;
+    aopts.bid_budget = opts.bid_budget;
+    auction_parameters instance_opts = opts;
+    instance_opts.numa = NUMA_NONE;
+
+    ManifestOptions mopts;
+    mopts.lookahead = 2 * omp_get_max_threads();
+    mopts.seed = opts.seed;
+    mopts.perfect = (opts.algorithm == 0);
+    mopts.abs_value = opts.abs_value;
+    mopts.one_sided = opts.one_sided;
+    mopts.random_weights = opts.random_weights;
+
+    double start = omp_get_wtime();
+    long failed = runManifest(entries, mopts, out, [&](CSR* G, Node* S, Arena* arena) {
+        preprocess_graph(*G, S, instance_opts, NULL);
+        AuctionOptions thread_opts = aopts;
+        thread_opts.arena = arena;
+        return run_checked_auction(G, S, instance_opts, thread_opts);
+    });
+    double elapsed = omp_get_wtime() - start;
+    if (out != stdout)
+        fclose(out);
+    else
+        fflush(out);
+
+    cout << endl << "Instances: " << entries.size() << " (" << failed << " unreadable)" << endl;
+    cout << "Manifest Time: " << elapsed << endl;
+    cout << "Throughput: " << entries.size() / elapsed << " instances/s" << endl << endl;
+    return failed == 0 ? 0 : -1;
+}
+
+// Loads every -f graph once and serves solve requests on them until stopped
+int run_daemon(auction_parameters& opts, Profiler* prof) {
+    if (opts.workers > 0) {
+        cerr << "Error: multi-process workers can't be combined with daemon mode" << endl;
+        return -1;
+    }
+    if (opts.batch_file || opts.bvalue_file || opts.output_file || opts.checkpoint_file || opts.resume_file || opts.compare)
+        cerr << "Warning: batch, b-value, output, checkpoint and comparison options are ignored in daemon mode" << endl;
+
+    vector<CSR*> graphs;
+    for (int k = 0; k < opts.graph_files.size(); k++) {
+        CSR* G = new CSR;
+        if (!G->readMtxB(opts.graph_files[k], opts.abs_value, opts.verbose, prof, opts.one_sided, opts.random_weights))
+            return -1;
+        preprocess_graph(*G, NULL, opts, prof);
+        cout << "Graph " << k << ": " << opts.graph_files[k] << " (|A|, |B|, n, m) := (" << G->lVer << ", " << G->rVer
+             << ", " << G->nVer << ", " << (G->oneSided ? G->nEdge : G->nEdge/2) << ")" << endl;
+        graphs.push_back(G);
+    }
+    cout << endl;
+
+    // Solver state is private to each request; the profiler is not thread safe
+    AuctionOptions aopts;
+    aopts.cache_slack = opts.cache_slack;
+    aopts.schedule = opts.schedule;
+    aopts.deadline = opts.deadline;
+    aopts.bid_budget = opts.bid_budget;
+    int jobs = (opts.jobs > 0) ? opts.jobs : omp_get_max_threads();
+    bool ok = runServer(opts.daemon_socket, graphs, jobs, aopts,
+        [&](CSR* G, Node* S, int algorithm, double epsilon, const AuctionOptions& thread_opts) {
+            auction_parameters request_opts = opts;
+            request_opts.algorithm = algorithm;
+            request_opts.epsilon = epsilon;
+            return run_checked_auction(G, S, request_opts, thread_opts);
+        });
+
+    for (CSR* G : graphs) {
+        delete G;
+    }
+    return ok ? 0 : -1;
+}
+
 int main(int argc, char** argv){
     cout.precision(dbl::max_digits10);
 
@@ -131,47 +662,125 @@ int main(int argc, char** argv){
     
     // Reading the input 
     double rt_start = omp_get_wtime();	
+    Profiler* prof = NULL;
+    if (opts.timers)
+        prof = new Profiler(opts.hw_counters);
+    if (opts.manifest_file != NULL) {
+        delete prof;
+        return run_manifest(opts);
+    }
+    if (opts.daemon_socket != NULL) {
+        int ret = run_daemon(opts, prof);
+        if (prof) {
+            prof->print();
+            delete prof;
+        }
+        return ret;
+    }
     CSR G;
-    G.readMtxB(opts.problem_name, opts.abs_value, opts.verbose);
+    if (!G.readMtxB(opts.problem_name, opts.abs_value, opts.verbose, prof, opts.one_sided, opts.random_weights)) {
+        delete prof;
+        return -1;
+    }
     
     // Memory Allocation
     Node* S = new Node[G.nVer];      
     cout << "Input Processing Done: " << omp_get_wtime() - rt_start << endl;	
-    cout << "(|A|, |B|, n, m) := (" << G.lVer << ", " << G.rVer << ", " << G.nVer << ", " << G.nEdge/2 << ")" << endl << endl;
+    cout << "(|A|, |B|, n, m) := (" << G.lVer << ", " << G.rVer << ", " << G.nVer << ", " << (G.oneSided ? G.nEdge : G.nEdge/2) << ")" << endl << endl;
+
+    AuctionOptions aopts;
+    aopts.prof = prof;
+    aopts.cache_slack = opts.cache_slack;
+    aopts.schedule = opts.schedule;
+    AuctionOutput output;
+    if (opts.output_file != NULL)
+        aopts.out = &output;
+    aopts.checkpoint_file = opts.checkpoint_file;
+    aopts.checkpoint_interval = opts.checkpoint_interval;
+    aopts.resume_file = opts.resume_file;
+    aopts.deadline = opts.deadline;
+    aopts.bid_budget = opts.bid_budget;
+    if (opts.progress_interval > 0) {
+        aopts.progress_interval = opts.progress_interval;
+        aopts.progress = [](const AuctionProgress& p) {
+            cout << "Progress: " << p.time << " s, " << p.rounds << " rounds, weight " << p.weight
+                 << ", bound " << p.bound << ", unsaturated bidders " << p.unsaturated << endl;
+        };
+    }
+    bool anytime = opts.deadline > 0 || opts.bid_budget > 0 || opts.progress_interval > 0;
+    if (anytime && (opts.algorithm == 0 || opts.workers > 0))
+        cerr << "Warning: deadlines, bid budgets and progress reports are only supported by the b-matching auction" << endl;
+    if ((opts.checkpoint_file || opts.resume_file) && (opts.decompose || opts.prune_slack >= 0 || opts.workers > 0 || opts.batch_file))
+        cerr << "Warning: checkpoints are only taken by the plain auctions" << endl;
+    if (opts.levels > 0 && (opts.decompose || opts.prune_slack >= 0 || opts.workers > 0))
+        cerr << "Warning: -l replaces decomposition, pruning and workers" << endl;
+    if (G.pattern && (anytime || opts.checkpoint_file || opts.resume_file || opts.levels > 0 || opts.decompose
+                      || opts.prune_slack >= 0 || opts.workers > 0))
+        cerr << "Warning: pattern inputs are solved by max-flow, which ignores the auction options (use -W to run the auction)" << endl;
+
+    if (!opts.has_seed && opts.bvalue_file == NULL && opts.batch_file == NULL) {
+        std::random_device rd;
+        opts.seed = ((uint64_t) rd() << 32) | rd();
+        cout << "Seed: " << opts.seed << endl << endl;
+    }
+
+    if (opts.batch_file != NULL) {
+        if (opts.workers > 0) {
+            cerr << "Error: multi-process workers can't be combined with batch mode" << endl;
+            delete[] S;
+            return -1;
+        }
+        int ret = run_batch(G, opts, aopts, prof);
+        if (prof) {
+            prof->print();
+            delete prof;
+        }
+        delete[] S;
+        return ret;
+    }
 
     // Randomly assign b-values based on algorithm and run
     if (opts.algorithm == 1){
         // b-matching auction algorithm
-        if (opts.verbose)
-            cout << "Randomly generating b-values" << endl;
 
         // Assignment of b-values
-        for (int i = 0; i < G.nVer; i++) {
-            int deg = 0;
-            for (int j = G.verPtr[i]; j < G.verPtr[i+1]; j++) {
-                if (G.verInd[j].weight >= 0) {
-                    deg++;
-                }
-            }
-            S[i].deg = deg;
-
-            // Taken from: https://stackoverflow.com/questions/7560114/random-number-c-in-some-range
-            std::random_device rd;
-            std::mt19937 gen(rd()); 
-            std::uniform_int_distribution<> distr(1, 10); // random integer in [1, deg]
-            S[i].b = distr(gen);
+        if (prof) prof->begin("B-Values");
+        if (opts.bvalue_file != NULL) {
+            if (!readBValues(opts.bvalue_file, &G, S))
+                return -1;
         }
+        else {
+            if (opts.verbose)
+                cout << "Randomly generating b-values" << endl;
+            randomBValues(&G, S, opts.seed);
+        }
+        if (prof) prof->end();
         /*
         for (int i = 0; i < G.nVer; i++) {
             cout << i << ": Degree is " << S[i].deg << ", b-value is " << S[i].b << endl;
         }
         */
-        AlgResult auc_res = bMatchingAuction(&G, S, opts.epsilon, opts.verbose);
+        preprocess_graph(G, S, opts, prof);
+        AlgResult auc_res = run_auction(&G, S, opts, aopts, opts.verbose);
 
-        cout << "\e[1mAuction (ε = " << opts.epsilon << ")\e[0m" << endl;
+        if (G.pattern)
+            cout << "\e[1mMaximum Cardinality (max-flow)\e[0m" << endl;
+        else
+            cout << "\e[1mAuction (ε = " << opts.epsilon << ")\e[0m" << endl;
         cout << "Total Weight: " << auc_res.weight << endl;
         cout << "Initialization Time: " << auc_res.init_time << endl;
         cout << "Running Time: " << auc_res.total_time << endl << endl;
+        if (auc_res.interrupted) {
+            cout << "Stopped early, dual bound: " << auc_res.bound;
+            if (auc_res.bound > 0)
+                cout << " (gap " << 100 * (auc_res.bound - auc_res.weight) / auc_res.bound << "%)";
+            cout << endl << endl;
+        }
+        if (!write_output(&G, opts, aopts, auc_res.weight, prof))
+            return -1;
+#ifdef AUCTION_STATS
+        auc_res.stats.print();
+#endif
 
         if (opts.compare) {
             AlgResult greedy_res = bMatchingGreedy(&G, S);
@@ -188,42 +797,23 @@ int main(int argc, char** argv){
     }
     else {
         // b-factor auction algorithm
-        if (opts.verbose)
-            cout << "Randomly generating b-values" << endl;
-
-        // Randomly generate a permutation of indices for the right side of the graph
-        vector<int> random_idx_perm;
-        random_idx_perm.reserve(G.rVer);
-        for (int i = G.lVer; i < G.nVer; i++) {
-            random_idx_perm.push_back(i);
-        }
-        shuffle(random_idx_perm.begin(), random_idx_perm.end(), default_random_engine(time(0)));
 
         // Assignment of b-values
-        int cardF = 0;
-        for (int i = 0; i < G.nVer; i++) {
-            int deg = 0;
-            for (int j = G.verPtr[i]; j < G.verPtr[i+1]; j++) {
-                if (G.verInd[j].weight >= 0) {
-                    deg++;
-                }
-            }
-            S[i].deg = deg;
-            
-            if (i < G.lVer) {
-                int deg_half = floor(deg/2);
-                int random_idx = random_idx_perm.back();
-                random_idx_perm.pop_back();
-                
-                // Taken from: https://stackoverflow.com/questions/7560114/random-number-c-in-some-range
-                std::random_device rd; 
-                std::mt19937 gen(rd()); 
-                std::uniform_int_distribution<> distr(1, deg_half); // random integer in [1, deg/2]
-                int b = distr(gen);
-                cardF += b;
-                S[i].b = S[random_idx].b = b;
+        if (prof) prof->begin("B-Values");
+        long cardF = 0;
+        if (opts.bvalue_file != NULL) {
+            if (!readBValues(opts.bvalue_file, &G, S))
+                return -1;
+            for (int i = 0; i < G.lVer; i++) {
+                cardF += S[i].b;
             }
         }
+        else {
+            if (opts.verbose)
+                cout << "Randomly generating b-values" << endl;
+            cardF = randomBFactorValues(&G, S, opts.seed);
+        }
+        if (prof) prof->end();
         /*
         for (int i = 0; i < G.nVer; i++) {
             cout << i << ": Degree is " << S[i].deg << ", b-value is " << S[i].b << endl;
@@ -232,13 +822,43 @@ int main(int argc, char** argv){
         cout << "Cardinality of F: " << cardF << endl << endl;
         float eps = 10000/cardF;
 
-        AlgResult auc_res = bFactorAuction(&G, S, opts.epsilon, opts.verbose);
-        cout << "\e[1mAuction (ε = " << opts.epsilon << ")\e[0m" << endl;
+        // An instance without a perfect b-matching would keep the auction bidding forever
+        if (opts.check_feasible) {
+            if (prof) prof->begin("Feasibility Check");
+            FeasibilityReport report;
+            bool feasible = checkBFactor(&G, S, report);
+            if (prof) prof->end();
+            if (!feasible) {
+                print_feasibility_report(&G, S, report);
+                if (!opts.fallback) {
+                    delete[] S;
+                    return -1;
+                }
+                cout << "Falling back to the b-matching auction" << endl << endl;
+                opts.algorithm = 1;
+            }
+        }
+
+        if (opts.prune_slack >= 0 && opts.algorithm == 0)
+            cerr << "Warning: edge pruning is only supported by the b-matching auction" << endl;
+        if (opts.workers > 0 && opts.algorithm == 0)
+            cerr << "Warning: multi-process workers are only supported by the b-matching auction" << endl;
+        preprocess_graph(G, S, opts, prof);
+        AlgResult auc_res = run_auction(&G, S, opts, aopts, opts.verbose);
+        if (G.pattern)
+            cout << "\e[1mMaximum Cardinality (max-flow)\e[0m" << endl;
+        else
+            cout << "\e[1mAuction (ε = " << opts.epsilon << ")\e[0m" << endl;
         cout << "Total Weight: " << auc_res.weight << endl;
         cout << "Initialization Time: " << auc_res.init_time << endl;
         cout << "Running Time: " << auc_res.total_time << endl << endl;
+        if (!write_output(&G, opts, aopts, auc_res.weight, prof))
+            return -1;
+#ifdef AUCTION_STATS
+        auc_res.stats.print();
+#endif
 
-        if (opts.compare){
+        if (opts.compare && opts.algorithm == 0){
             AlgResult ns_res = bFactorComparison_NS(&G, S);
             AlgResult cs_res = bFactorComparison_CS(&G, S);
 
@@ -247,30 +867,11 @@ int main(int argc, char** argv){
         }
     }
     
+    if (prof) {
+        prof->print();
+        delete prof;
+    }
     delete[] S;
     
     return 0;
-    /*
-	if(opts.verbose)
-	{
-		ofstream fout;
-		fout.open("matching.txt",ios::out);
-		if(fout.is_open())
-		{
-			fout<<"*Vertices "<<G.nVer<<endl;
-			fout<<"*arcs"<<endl;
-			for(int i=0;i<G.nVer;i++)
-				for(int j=0;j<S[i].curSize;j++)
-					if(i>S[i].heap[j].id)
-						fout<<i+1<<" "<<S[i].heap[j].id+1<<" "<<S[i].heap[j].weight<<endl;
-		}
-		fout.close();
-	}
-    for(int i=0;i<G.nVer;i++)
-        delete S[i].heap;
-    
-    delete S;
-    
-    return 0;
-    */
 }
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "include/manifest.h"
+#include "include/bvalues.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <thread>
+using namespace std;
+
+bool readManifest(const char* filename, vector<ManifestEntry>& entries) {
+    ifstream inf(filename, ios::in);
+    if (!inf.is_open()) {
+        cerr << "Error: can't open manifest " << filename << endl;
+        return false;
+    }
+
+    string dir = filename;
+    size_t slash = dir.rfind('/');
+    dir = (slash == string::npos) ? "" : dir.substr(0, slash + 1);
+
+    string line;
+    while (getline(inf, line)) {
+        istringstream words(line);
+        ManifestEntry e;
+        if (!(words >> e.graph) || e.graph[0] == '%' || e.graph[0] == '#')
+            continue;
+        words >> e.bvalues;
+        if (e.graph[0] != '/')
+            e.graph = dir + e.graph;
+        if (!e.bvalues.empty() && e.bvalues[0] != '/')
+            e.bvalues = dir + e.bvalues;
+        entries.push_back(e);
+    }
+    return true;
+}
+
+// An instance read ahead of the solvers
+struct LoadedInstance {
+    int index;
+    CSR* G;             // NULL if the graph or b-values could not be read
+    vector<Node> S;
+};
+
+// Bounded queue between the reader thread and the solvers
+class InstanceQueue {
+    public:
+    InstanceQueue(int capacity) : capacity(capacity), closed(false) { }
+
+    void push(LoadedInstance* inst) {
+        unique_lock<mutex> guard(lock);
+        room.wait(guard, [this]() { return items.size() < capacity; });
+        items.push_back(inst);
+        ready.notify_one();
+    }
+
+    // Returns NULL once the queue is closed and drained
+    LoadedInstance* pop() {
+        unique_lock<mutex> guard(lock);
+        ready.wait(guard, [this]() { return closed || !items.empty(); });
+        if (items.empty())
+            return NULL;
+        LoadedInstance* inst = items.front();
+        items.pop_front();
+        room.notify_one();
+        return inst;
+    }
+
+    void close() {
+        lock_guard<mutex> guard(lock);
+        closed = true;
+        ready.notify_all();
+    }
+
+    private:
+    int capacity;
+    bool closed;
+    deque<LoadedInstance*> items;
+    mutex lock;
+    condition_variable ready, room;
+};
+
+static LoadedInstance* loadInstance(const ManifestEntry& e, int index, const ManifestOptions& mopts) {
+    LoadedInstance* inst = new LoadedInstance;
+    inst->index = index;
+    inst->G = new CSR;
+    CSR* G = inst->G;
+    if (!G->readMtxB((char*) e.graph.c_str(), mopts.abs_value, false, NULL, mopts.one_sided, mopts.random_weights)) {
+        cerr << "Error: can't read graph " << e.graph << endl;
+        delete G;
+        inst->G = NULL;
+        return inst;
+    }
+
+    inst->S.resize(G->nVer);
+    Node* S = inst->S.data();
+    if (!e.bvalues.empty()) {
+        if (!readBValues(e.bvalues.c_str(), G, S)) {
+            delete G;
+            inst->G = NULL;
+        }
+    }
+    else if (mopts.perfect) {
+        randomBFactorValues(G, S, mopts.seed + index);
+    }
+    else {
+        randomBValues(G, S, mopts.seed + index);
+    }
+    return inst;
+}
+
+long runManifest(const vector<ManifestEntry>& entries, const ManifestOptions& mopts, FILE* out, const ManifestSolver& solve) {
+    InstanceQueue queue(max(1, mopts.lookahead));
+    thread reader([&]() {
+        omp_set_num_threads(1);     // The cores belong to the solvers
+        for (int k = 0; k < entries.size(); k++) {
+            queue.push(loadInstance(entries[k], k, mopts));
+        }
+        queue.close();
+    });
+
+    fprintf(out, "%% instance graph weight time status\n");
+    mutex out_lock;
+    long failed = 0;
+    #pragma omp parallel reduction(+:failed)
+    {
+        Arena arena;
+        LoadedInstance* inst;
+        while ((inst = queue.pop()) != NULL) {
+            const char* graph = entries[inst->index].graph.c_str();
+            if (inst->G == NULL) {
+                failed++;
+                lock_guard<mutex> guard(out_lock);
+                fprintf(out, "%d %s - - unreadable\n", inst->index, graph);
+            }
+            else {
+                AlgResult res = solve(inst->G, inst->S.data(), &arena);
+                const char* status = "ok";
+                if (res.infeasible)
+                    status = res.fallback ? "fallback" : "infeasible";
+                else if (res.interrupted)
+                    status = "interrupted";
+                lock_guard<mutex> guard(out_lock);
+                fprintf(out, "%d %s %.17g %.9g %s\n", inst->index, graph, res.weight, res.total_time, status);
+            }
+            delete inst->G;
+            delete inst;
+        }
+    }
+    reader.join();
+    return failed;
+}
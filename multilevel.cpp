@@ -0,0 +1,215 @@
+#include "include/multilevel.h"
+#include <algorithm>
+#include <cfloat>
+using namespace std;
+
+// Pairs up the vertices with the same key, in order of appearance; vertices
+// with key -1 or without a partner stay alone. Groups are numbered in order
+// of their first member. Returns the number of groups.
+static int pairByKey(const vector<int>& key, int numKeys, vector<int>& group) {
+    vector<int> waiting(numKeys, -1);
+    group.assign(key.size(), -1);
+    int groups = 0;
+    for (int v = 0; v < key.size(); v++) {
+        int k = key[v];
+        if (k >= 0 && waiting[k] >= 0) {
+            group[v] = group[waiting[k]];
+            waiting[k] = -1;
+        }
+        else {
+            group[v] = groups++;
+            if (k >= 0)
+                waiting[k] = v;
+        }
+    }
+    return groups;
+}
+
+bool coarsenGraph(CSR* G, Node* S, CoarseGraph& coarse) {
+    // Heaviest edge out of every bidder and into every object
+    vector<int> topObject(G->lVer, -1), topBidder(G->rVer, -1);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int i = 0; i < G->lVer; i++) {
+        float best = -FLT_MAX;
+        for (int j = G->verPtr[i]; j < G->verPtr[i+1]; j++) {
+            Edge e = G->verInd[j];
+            if (e.weight >= 0 && e.weight > best) {
+                best = e.weight;
+                topObject[i] = e.id - G->lVer;
+            }
+        }
+    }
+    vector<float> topWeight(G->rVer, -FLT_MAX);
+    for (int i = 0; i < G->lVer; i++) {
+        for (int j = G->verPtr[i]; j < G->verPtr[i+1]; j++) {
+            Edge e = G->verInd[j];
+            int o = e.id - G->lVer;
+            if (e.weight >= 0 && e.weight > topWeight[o]) {
+                topWeight[o] = e.weight;
+                topBidder[o] = i;
+            }
+        }
+    }
+
+    vector<int> leftGroup, rightGroup;
+    int cl = pairByKey(topObject, G->rVer, leftGroup);
+    int cr = pairByKey(topBidder, G->lVer, rightGroup);
+    if (cl + cr > 0.9 * G->nVer)
+        return false;
+
+    CSR& C = coarse.G;
+    C.lVer = cl;
+    C.rVer = cr;
+    C.nVer = cl + cr;
+    coarse.map.resize(G->nVer);
+    for (int i = 0; i < G->lVer; i++) {
+        coarse.map[i] = leftGroup[i];
+    }
+    for (int o = 0; o < G->rVer; o++) {
+        coarse.map[G->lVer + o] = cl + rightGroup[o];
+    }
+    coarse.S.resize(C.nVer);
+    for (Node& n : coarse.S) {
+        n.b = 0;
+        n.deg = 0;
+    }
+    for (int v = 0; v < G->nVer; v++) {
+        coarse.S[coarse.map[v]].b += S[v].b;
+    }
+
+    vector<int> first(cl, -1), second(cl, -1);
+    for (int i = 0; i < G->lVer; i++) {
+        int a = leftGroup[i];
+        if (first[a] < 0)
+            first[a] = i;
+        else
+            second[a] = i;
+    }
+
+    // Rows of the coarse bidders, merging parallel edges into their mean
+    vector<vector<Edge>> rows(cl);
+    #pragma omp parallel
+    {
+        vector<int> slot(cr, -1);   // Position of each coarse object in the row being built
+        vector<int> count;
+        #pragma omp for schedule(dynamic, 1024)
+        for (int a = 0; a < cl; a++) {
+            vector<Edge>& row = rows[a];
+            count.clear();
+            for (int m : {first[a], second[a]}) {
+                if (m < 0)
+                    continue;
+                for (int j = G->verPtr[m]; j < G->verPtr[m+1]; j++) {
+                    Edge e = G->verInd[j];
+                    if (e.weight < 0)
+                        continue;
+                    int o = rightGroup[e.id - G->lVer];
+                    if (slot[o] < 0) {
+                        slot[o] = row.size();
+                        row.push_back(Edge(cl + o, e.weight));
+                        count.push_back(1);
+                    }
+                    else {
+                        row[slot[o]].weight += e.weight;
+                        count[slot[o]]++;
+                    }
+                }
+            }
+            for (int k = 0; k < row.size(); k++) {
+                slot[row[k].id - cl] = -1;
+                row[k].weight /= count[k];
+            }
+        }
+    }
+
+    C.verPtr = new int[C.nVer+1];
+    C.verPtr[0] = 0;
+    for (int v = 0; v < C.nVer; v++) {
+        C.verPtr[v+1] = C.verPtr[v] + ((v < cl) ? rows[v].size() : 0);
+    }
+    C.nEdge = C.verPtr[C.nVer];
+    C.verInd = new Edge[C.nEdge];
+    C.maxWeight = 0;
+    for (int a = 0; a < cl; a++) {
+        copy(rows[a].begin(), rows[a].end(), C.verInd + C.verPtr[a]);
+        coarse.S[a].deg = rows[a].size();
+        for (Edge e : rows[a]) {
+            coarse.S[e.id].deg++;
+            C.maxWeight = max(C.maxWeight, e.weight);
+        }
+    }
+    C.maxDeg = 0;
+    for (Node& n : coarse.S) {
+        C.maxDeg = max(C.maxDeg, n.deg);
+    }
+    C.avgDeg = (C.nVer > 0) ? 2.0 * C.nEdge / C.nVer : 0;
+    C.oneSided = true;
+    return true;
+}
+
+AlgResult multilevelAuction(CSR* G, Node* S, double epsilon, int levels, bool perfect, bool verbose, const AuctionOptions& aopts) {
+    double start = omp_get_wtime();
+    if (aopts.prof) aopts.prof->begin("Coarsen");
+
+    vector<CoarseGraph*> hierarchy;
+    CSR* fine = G;
+    Node* fineS = S;
+    while (hierarchy.size() < levels) {
+        CoarseGraph* coarse = new CoarseGraph;
+        if (!coarsenGraph(fine, fineS, *coarse)) {
+            delete coarse;
+            break;
+        }
+        hierarchy.push_back(coarse);
+        fine = &coarse->G;
+        fineS = coarse->S.data();
+        if (verbose)
+            cout << "Level " << hierarchy.size() << ": (|A|, |B|, n, m) := (" << fine->lVer << ", " << fine->rVer
+                 << ", " << fine->nVer << ", " << fine->nEdge << ")" << endl;
+    }
+    if (aopts.prof) {
+        aopts.prof->end();
+        aopts.prof->begin("Coarse Levels");
+    }
+
+    // Solve from the coarsest level down, each one from the prices of the
+    // level above projected onto its objects
+    AuctionOutput out;
+    AuctionOptions sub_opts;
+    sub_opts.cache_slack = aopts.cache_slack;
+    sub_opts.schedule = aopts.schedule;
+    sub_opts.arena = aopts.arena;
+    sub_opts.out = &out;
+    vector<float> prices;
+    for (int k = (int) hierarchy.size() - 1; k >= 0; k--) {
+        CoarseGraph* coarse = hierarchy[k];
+        sub_opts.warm_prices = prices.empty() ? NULL : &prices;
+        AlgResult r = bMatchingAuction(&coarse->G, coarse->S.data(), epsilon, false, sub_opts);
+        if (verbose)
+            cout << "Level " << k + 1 << ": weight " << r.weight << ", time " << r.total_time << endl;
+
+        CSR* below = (k > 0) ? &hierarchy[k-1]->G : G;
+        prices.resize(below->rVer);
+        for (int o = 0; o < below->rVer; o++) {
+            prices[o] = out.prices[coarse->map[below->lVer + o] - coarse->G.lVer];
+        }
+    }
+    for (CoarseGraph* coarse : hierarchy) {
+        delete coarse;
+    }
+    if (aopts.prof) aopts.prof->end();
+    if (verbose && !hierarchy.empty())
+        cout << endl;
+
+    double time_init = omp_get_wtime();
+    AuctionOptions fine_opts = aopts;
+    fine_opts.warm_prices = prices.empty() ? NULL : &prices;
+    AlgResult res = perfect ? bFactorAuction(G, S, epsilon, false, fine_opts) : bMatchingAuction(G, S, epsilon, false, fine_opts);
+
+    double end = omp_get_wtime();
+    AlgResult total(end - start, time_init - start + res.init_time, res.weight);
+    total.interrupted = res.interrupted;
+    total.bound = res.bound;
+    STATS_DO(total.stats = res.stats;)
+    return total;
+}
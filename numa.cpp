@@ -0,0 +1,158 @@
+#include "include/numa.h"
+#include <cstring>
+#include <cstdint>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+using namespace std;
+
+// From <numaif.h>, which is only installed with libnuma
+#ifndef MPOL_BIND
+#define MPOL_BIND       2
+#define MPOL_INTERLEAVE 3
+#define MPOL_MF_MOVE    (1 << 1)
+#endif
+
+bool parseNumaPolicy(const char* name, NumaPolicy& policy) {
+    if (strcmp(name, "none") == 0)
+        policy = NUMA_NONE;
+    else if (strcmp(name, "local") == 0)
+        policy = NUMA_LOCAL;
+    else if (strcmp(name, "interleave") == 0)
+        policy = NUMA_INTERLEAVE;
+    else
+        return false;
+    return true;
+}
+
+// Parses a sysfs list such as "0-3,8-11"
+static vector<int> readList(const string& path) {
+    vector<int> ids;
+    ifstream in(path);
+    string s;
+    if (!getline(in, s))
+        return ids;
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t comma = s.find(',', pos);
+        string range = s.substr(pos, comma == string::npos ? string::npos : comma - pos);
+        size_t dash = range.find('-');
+        int lo = atoi(range.c_str());
+        int hi = (dash == string::npos) ? lo : atoi(range.c_str() + dash + 1);
+        for (int k = lo; k <= hi; k++) {
+            ids.push_back(k);
+        }
+        if (comma == string::npos)
+            break;
+        pos = comma + 1;
+    }
+    return ids;
+}
+
+static vector<int> nodeIds() {
+    vector<int> ids = readList("/sys/devices/system/node/online");
+    if (ids.empty())
+        ids.push_back(0);
+    return ids;
+}
+
+int threadNode(int t, int nThreads, int nodes) {
+    return (int) ((long) t * nodes / nThreads);
+}
+
+bool pinThreads() {
+    vector<int> ids = nodeIds();
+    vector<vector<int>> cpus(ids.size());
+    for (int k = 0; k < ids.size(); k++) {
+        cpus[k] = readList("/sys/devices/system/node/node" + to_string(ids[k]) + "/cpulist");
+    }
+
+    bool ok = true;
+    #pragma omp parallel reduction(&&:ok)
+    {
+        int node = threadNode(omp_get_thread_num(), omp_get_num_threads(), ids.size());
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int c : cpus[node]) {
+            CPU_SET(c, &set);
+        }
+        ok = !cpus[node].empty() && sched_setaffinity(0, sizeof(set), &set) == 0;
+    }
+    return ok;
+}
+
+vector<int> numaBlocks(CSR* G, int nodes) {
+    vector<int> blocks(nodes + 1, G->lVer);
+    blocks[0] = 0;
+    long nLeft = G->verPtr[G->lVer];
+    int v = 0;
+    for (int k = 1; k < nodes; k++) {
+        long target = nLeft * k / nodes;
+        while (v < G->lVer && G->verPtr[v] < target)
+            v++;
+        blocks[k] = v;
+    }
+    return blocks;
+}
+
+// Applies a memory policy to the whole pages inside [addr, addr + bytes)
+// and migrates the pages already placed elsewhere.
+static bool movePages(const void* addr, size_t bytes, int mode, unsigned long mask) {
+    uintptr_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t start = ((uintptr_t) addr + page - 1) & ~(page - 1);
+    uintptr_t end = ((uintptr_t) addr + bytes) & ~(page - 1);
+    if (end <= start)
+        return true;
+    return syscall(SYS_mbind, start, end - start, mode, &mask, sizeof(mask) * 8 + 1, MPOL_MF_MOVE) == 0;
+}
+
+bool placeGraph(CSR* G, NumaPolicy policy) {
+    vector<int> ids = nodeIds();
+    int nodes = ids.size();
+    if (policy == NUMA_NONE || nodes < 2)
+        return true;
+    if (ids.back() >= 8 * (int) sizeof(unsigned long)) {
+        cout << "Warning: NUMA node ids above " << 8 * sizeof(unsigned long) - 1 << " are not supported" << endl;
+        return false;
+    }
+
+    unsigned long all = 0;
+    for (int id : ids) {
+        all |= 1UL << id;
+    }
+
+    bool ok = true;
+    PackedRows* P = G->packed;
+    if (policy == NUMA_INTERLEAVE) {
+        ok &= movePages(G->verPtr, (G->nVer + 1) * sizeof(int), MPOL_INTERLEAVE, all);
+        if (G->verInd != NULL)
+            ok &= movePages(G->verInd, (size_t) G->nEdge * sizeof(Edge), MPOL_INTERLEAVE, all);
+        if (P != NULL) {
+            ok &= movePages(P->ids.data(), P->ids.size(), MPOL_INTERLEAVE, all);
+            ok &= movePages(P->weights.data(), P->weights.size() * sizeof(float), MPOL_INTERLEAVE, all);
+            ok &= movePages(P->qweights.data(), P->qweights.size() * sizeof(uint16_t), MPOL_INTERLEAVE, all);
+        }
+        return ok;
+    }
+
+    // Left rows go to the node of their block, right rows are interleaved
+    vector<int> blocks = numaBlocks(G, nodes);
+    for (int k = 0; k < nodes; k++) {
+        unsigned long mask = 1UL << ids[k];
+        int lo = blocks[k], hi = blocks[k+1];
+        ok &= movePages(G->verPtr + lo, (hi - lo + 1) * sizeof(int), MPOL_BIND, mask);
+        if (G->verInd != NULL)
+            ok &= movePages(G->verInd + G->verPtr[lo], (size_t) (G->verPtr[hi] - G->verPtr[lo]) * sizeof(Edge), MPOL_BIND, mask);
+        if (P != NULL) {
+            ok &= movePages(P->ids.data() + P->bytePtr[lo], P->bytePtr[hi] - P->bytePtr[lo], MPOL_BIND, mask);
+            if (P->quantized)
+                ok &= movePages(P->qweights.data() + G->verPtr[lo], (size_t) (G->verPtr[hi] - G->verPtr[lo]) * sizeof(uint16_t), MPOL_BIND, mask);
+            else
+                ok &= movePages(P->weights.data() + G->verPtr[lo], (size_t) (G->verPtr[hi] - G->verPtr[lo]) * sizeof(float), MPOL_BIND, mask);
+        }
+    }
+    ok &= movePages(G->verPtr + G->lVer, (G->rVer + 1) * sizeof(int), MPOL_INTERLEAVE, all);
+    if (G->verInd != NULL)
+        ok &= movePages(G->verInd + G->verPtr[G->lVer], (size_t) (G->nEdge - G->verPtr[G->lVer]) * sizeof(Edge), MPOL_INTERLEAVE, all);
+    return ok;
+}
@@ -0,0 +1,106 @@
+#include "include/output.h"
+#include <cstdio>
+#include <cstring>
+#include <cfloat>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+using namespace std;
+
+const char matchingMagic[8] = {'B', 'M', 'A', 'T', 'C', 'H', 0, 1};
+
+static int inputId(CSR* G, int v) {
+    return (G->origId != NULL) ? G->origId[v] : v;
+}
+
+void fillMatching(CSR* G, const AuctionOutput& out, MatchingRecord* rec, float* prices) {
+    long n = out.matching.size();
+    #pragma omp parallel for schedule(static)
+    for (long k = 0; k < n; k++) {
+        const MatchedEdge& m = out.matching[k];
+        rec[k].bidder = inputId(G, m.bidder);
+        rec[k].object = inputId(G, m.object) - G->lVer;
+        rec[k].weight = m.weight;
+        rec[k].price = m.price;
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (int o = 0; o < G->rVer; o++) {
+        prices[inputId(G, G->lVer + o) - G->lVer] = out.prices[o];
+    }
+}
+
+static void fillBinary(CSR* G, const AuctionOutput& out, double weight, char* dst) {
+    MatchingFileHeader* h = (MatchingFileHeader*) dst;
+    memcpy(h->magic, matchingMagic, sizeof(h->magic));
+    h->numBidders = G->lVer;
+    h->numObjects = G->rVer;
+    h->numMatched = out.matching.size();
+    h->weight = weight;
+
+    MatchingRecord* rec = (MatchingRecord*) (dst + sizeof(MatchingFileHeader));
+    fillMatching(G, out, rec, (float*) (rec + out.matching.size()));
+}
+
+static bool writeBinary(const char* filename, CSR* G, const AuctionOutput& out, double weight, bool use_mmap) {
+    size_t bytes = sizeof(MatchingFileHeader) + out.matching.size() * sizeof(MatchingRecord) + G->rVer * sizeof(float);
+
+    if (use_mmap) {
+        int fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            return false;
+        if (ftruncate(fd, bytes) != 0) {
+            close(fd);
+            return false;
+        }
+        void* p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        fillBinary(G, out, weight, (char*) p);
+        bool ok = munmap(p, bytes) == 0;
+        return close(fd) == 0 && ok;
+    }
+
+    vector<char> buf(bytes);
+    fillBinary(G, out, weight, buf.data());
+    FILE* f = fopen(filename, "wb");
+    if (f == NULL)
+        return false;
+    bool ok = fwrite(buf.data(), 1, bytes, f) == bytes;
+    return fclose(f) == 0 && ok;
+}
+
+static bool writeText(const char* filename, CSR* G, const AuctionOutput& out, double weight) {
+    FILE* f = fopen(filename, "w");
+    if (f == NULL)
+        return false;
+
+    fprintf(f, "%% rows %d columns %d matched %zu weight %.17g\n", G->lVer, G->rVer, out.matching.size(), weight);
+    for (auto& m : out.matching) {
+        fprintf(f, "%d %d %.9g %.9g\n", inputId(G, m.bidder) + 1, inputId(G, m.object) - G->lVer + 1, m.weight, m.price);
+    }
+
+    vector<float> prices(G->rVer);
+    for (int o = 0; o < G->rVer; o++) {
+        prices[inputId(G, G->lVer + o) - G->lVer] = out.prices[o];
+    }
+    fprintf(f, "%% prices\n");
+    for (int o = 0; o < G->rVer; o++) {
+        if (prices[o] == FLT_MAX)
+            fprintf(f, "%d inf\n", o + 1);
+        else
+            fprintf(f, "%d %.9g\n", o + 1, prices[o]);
+    }
+    return fclose(f) == 0;
+}
+
+bool writeMatching(const char* filename, CSR* G, const AuctionOutput& out, double weight, bool use_mmap) {
+    size_t len = strlen(filename);
+    bool binary = len >= 4 && strcmp(filename + len - 4, ".bin") == 0;
+    bool ok = binary ? writeBinary(filename, G, out, weight, use_mmap) : writeText(filename, G, out, weight);
+    if (!ok)
+        cerr << "Error: can't write the matching to " << filename << endl;
+    return ok;
+}
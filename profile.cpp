@@ -0,0 +1,103 @@
+#include "include/profile.h"
+#include <omp.h>
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+using namespace std;
+
+static int openCounter(unsigned long long config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = 1;   // Also count OpenMP threads spawned later
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+Profiler::Profiler(bool hw_counters) : hw(hw_counters), start_time(0) {
+    const unsigned long long configs[numCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    for (int k = 0; k < numCounters; k++) {
+        fds[k] = -1;
+        start_counts[k] = 0;
+    }
+    if (!hw)
+        return;
+
+    for (int k = 0; k < numCounters; k++) {
+        fds[k] = openCounter(configs[k]);
+        if (fds[k] < 0) {
+            cerr << "Warning: perf_event_open failed (" << strerror(errno) << "), "
+                 << "hardware counters disabled" << endl;
+            hw = false;
+            break;
+        }
+    }
+
+    if (!hw) {
+        for (int k = 0; k < numCounters; k++) {
+            if (fds[k] >= 0)
+                close(fds[k]);
+            fds[k] = -1;
+        }
+    }
+}
+
+Profiler::~Profiler() {
+    for (int k = 0; k < numCounters; k++) {
+        if (fds[k] >= 0)
+            close(fds[k]);
+    }
+}
+
+void Profiler::readCounters(long long* counts) {
+    for (int k = 0; k < numCounters; k++) {
+        counts[k] = 0;
+        if (read(fds[k], &counts[k], sizeof(long long)) != sizeof(long long))
+            counts[k] = -1;
+    }
+}
+
+void Profiler::begin(const string& name) {
+    phases.push_back(PhaseSample(name));
+    if (hw)
+        readCounters(start_counts);
+    start_time = omp_get_wtime();
+}
+
+void Profiler::end() {
+    double end_time = omp_get_wtime();
+    PhaseSample& p = phases.back();
+    p.time = end_time - start_time;
+    if (hw) {
+        long long counts[numCounters];
+        readCounters(counts);
+        p.cycles = counts[0] - start_counts[0];
+        p.cache_misses = counts[1] - start_counts[1];
+        p.branch_misses = counts[2] - start_counts[2];
+    }
+}
+
+void Profiler::print() {
+    cout << "\e[1mPhase Breakdown\e[0m" << endl;
+    for (auto& p : phases) {
+        cout << p.name << ": " << p.time;
+        if (hw) {
+            cout << " (cycles: " << p.cycles << ", cache misses: " << p.cache_misses
+                 << ", branch misses: " << p.branch_misses << ")";
+        }
+        cout << endl;
+    }
+    cout << endl;
+}
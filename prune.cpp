@@ -0,0 +1,216 @@
+#include "include/prune.h"
+#include <algorithm>
+#include <cfloat>
+using namespace std;
+
+// Weight of the k-th heaviest entry of w, or -FLT_MAX if there are at most k
+static float kthHeaviest(vector<float>& w, int k) {
+    if (w.size() <= k)
+        return -FLT_MAX;
+    nth_element(w.begin(), w.begin() + (k-1), w.end(), greater<float>());
+    return w[k-1];
+}
+
+void pruneEdges(CSR* G, Node* S, int slack, vector<char>& keep) {
+    vector<float> threshold(G->nVer, -FLT_MAX);
+
+    // Group the left-side edge weights by right endpoint
+    vector<int> colPtr(G->rVer+1, 0);
+    for (int i = 0; i < G->lVer; i++) {
+        for (int j = G->verPtr[i]; j < G->verPtr[i+1]; j++) {
+            if (G->verInd[j].weight >= 0)
+                colPtr[G->verInd[j].id - G->lVer + 1]++;
+        }
+    }
+    for (int k = 0; k < G->rVer; k++) {
+        colPtr[k+1] += colPtr[k];
+    }
+    vector<float> colWeight(colPtr[G->rVer]);
+    vector<int> fill(colPtr.begin(), colPtr.end() - 1);
+    for (int i = 0; i < G->lVer; i++) {
+        for (int j = G->verPtr[i]; j < G->verPtr[i+1]; j++) {
+            if (G->verInd[j].weight >= 0)
+                colWeight[fill[G->verInd[j].id - G->lVer]++] = G->verInd[j].weight;
+        }
+    }
+
+    #pragma omp parallel
+    {
+        vector<float> w;
+        #pragma omp for schedule(dynamic, 1024)
+        for (int i = 0; i < G->lVer; i++) {
+            w.clear();
+            for (int j = G->verPtr[i]; j < G->verPtr[i+1]; j++) {
+                if (G->verInd[j].weight >= 0)
+                    w.push_back(G->verInd[j].weight);
+            }
+            threshold[i] = kthHeaviest(w, S[i].b + slack);
+        }
+
+        #pragma omp for schedule(dynamic, 1024)
+        for (int k = 0; k < G->rVer; k++) {
+            w.assign(colWeight.begin() + colPtr[k], colWeight.begin() + colPtr[k+1]);
+            threshold[G->lVer + k] = kthHeaviest(w, S[G->lVer + k].b + slack);
+        }
+    }
+
+    keep.assign(G->nEdge, 0);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int i = 0; i < G->lVer; i++) {
+        for (int j = G->verPtr[i]; j < G->verPtr[i+1]; j++) {
+            Edge e = G->verInd[j];
+            if (e.weight >= 0 && (e.weight >= threshold[i] || e.weight >= threshold[e.id]))
+                keep[j] = 1;
+        }
+    }
+}
+
+void buildPrunedCSR(CSR* G, const vector<char>& keep, CSR& sub) {
+    sub.nVer = G->nVer;
+    sub.lVer = G->lVer;
+    sub.rVer = G->rVer;
+    sub.verPtr = new int[G->nVer+1];
+
+    // Row lengths: kept edges for left vertices, their transpose for right
+    // ones unless G is one-sided
+    vector<int> deg(G->nVer, 0);
+    vector<int> rightDeg(G->nVer, 0);
+    for (int i = 0; i < G->lVer; i++) {
+        for (int j = G->verPtr[i]; j < G->verPtr[i+1]; j++) {
+            if (keep[j]) {
+                deg[i]++;
+                rightDeg[G->verInd[j].id]++;
+            }
+        }
+    }
+    if (!G->oneSided) {
+        for (int v = G->lVer; v < G->nVer; v++) {
+            deg[v] = rightDeg[v];
+        }
+    }
+    sub.verPtr[0] = 0;
+    for (int v = 0; v < G->nVer; v++) {
+        sub.verPtr[v+1] = sub.verPtr[v] + deg[v];
+    }
+    sub.nEdge = sub.verPtr[G->nVer];
+    sub.verInd = new Edge[sub.nEdge];
+
+    vector<int> fill(sub.verPtr, sub.verPtr + G->nVer);
+    int maxDeg = 0;
+    for (int i = 0; i < G->lVer; i++) {
+        for (int j = G->verPtr[i]; j < G->verPtr[i+1]; j++) {
+            if (keep[j]) {
+                Edge e = G->verInd[j];
+                sub.verInd[fill[i]++] = e;
+                if (!G->oneSided)
+                    sub.verInd[fill[e.id]++] = Edge(i, e.weight);
+            }
+        }
+    }
+    for (int v = 0; v < G->nVer; v++) {
+        maxDeg = max(maxDeg, max(deg[v], rightDeg[v]));
+    }
+    sub.maxDeg = maxDeg;
+    sub.maxWeight = G->maxWeight;
+    sub.avgDeg = (double) sub.nEdge / G->nVer;
+    sub.weightSorted = G->weightSorted;   // Filtering keeps the row order
+    sub.oneSided = G->oneSided;
+}
+
+// Marks pruned edges that violate eps-complementary slackness under the
+// final prices of out. A bidder holding fewer than b objects must see no
+// pruned edge worth at least epsilon, and a saturated one none worth more
+// than its least valuable object plus epsilon. Only the b+1 most valuable
+// violations of a bidder are added, as no more can enter its next bid.
+// Returns the number of edges marked.
+static int addViolations(CSR* G, Node* S, const AuctionOutput& out, double epsilon, vector<char>& keep) {
+    vector<int> held(G->lVer, 0);
+    vector<float> minHeld(G->lVer, FLT_MAX);
+    for (auto& m : out.matching) {
+        held[m.bidder]++;
+        minHeld[m.bidder] = min(minHeld[m.bidder], m.weight - m.price);
+    }
+
+    int violations = 0;
+    #pragma omp parallel reduction(+:violations)
+    {
+        vector<pair<float, int>> found;
+        #pragma omp for schedule(dynamic, 1024)
+        for (int i = 0; i < G->lVer; i++) {
+            bool saturated = held[i] >= S[i].b;
+            double bound = saturated ? minHeld[i] + epsilon : epsilon;
+            found.clear();
+            for (int j = G->verPtr[i]; j < G->verPtr[i+1]; j++) {
+                Edge e = G->verInd[j];
+                if (keep[j] || e.weight < 0)
+                    continue;
+                float value = e.weight - out.prices[e.id - G->lVer];
+                if (value > bound || (!saturated && value >= bound))
+                    found.push_back(make_pair(value, j));
+            }
+
+            int k = min((int) found.size(), S[i].b + 1);
+            partial_sort(found.begin(), found.begin() + k, found.end(), greater<pair<float, int>>());
+            for (int t = 0; t < k; t++) {
+                keep[found[t].second] = 1;
+            }
+            violations += k;
+        }
+    }
+    return violations;
+}
+
+AlgResult prunedAuction(CSR* G, Node* S, double epsilon, int slack, bool verbose, const AuctionOptions& aopts) {
+    double start = omp_get_wtime();
+    if (aopts.prof) aopts.prof->begin("Prune");
+
+    vector<char> keep;
+    pruneEdges(G, S, slack, keep);
+
+    double time_init = omp_get_wtime();
+    if (aopts.prof) aopts.prof->end();
+
+    AuctionOutput out;
+    AuctionOptions sub_opts = aopts;
+    sub_opts.out = &out;
+    sub_opts.checkpoint_file = NULL;    // Every round solves a different graph
+    sub_opts.resume_file = NULL;
+
+    AlgResult res(0, 0, 0);
+    int rounds = 0;
+    while (true) {
+        CSR sub;
+        buildPrunedCSR(G, keep, sub);
+        rounds++;
+        if (verbose)
+            cout << "Pruned round " << rounds << ": " << (sub.oneSided ? sub.nEdge : sub.nEdge/2)
+                 << " of " << (G->oneSided ? G->nEdge : G->nEdge/2) << " edges" << endl;
+
+        if (aopts.deadline > 0)
+            sub_opts.deadline = max(1e-6, aopts.deadline - (omp_get_wtime() - time_init));
+        res = bMatchingAuction(&sub, S, epsilon, false, sub_opts);
+        if (res.interrupted)
+            break;
+
+        if (aopts.prof) aopts.prof->begin("Verify");
+        int violations = addViolations(G, S, out, epsilon, keep);
+        if (aopts.prof) aopts.prof->end();
+        if (violations == 0)
+            break;
+        if (verbose)
+            cout << "Re-adding " << violations << " violating edges" << endl;
+    }
+
+    if (aopts.out)
+        *aopts.out = out;
+
+    double end = omp_get_wtime();
+    AlgResult total(end - start, time_init - start, res.weight);
+    if (res.interrupted) {
+        // The pruned graph's bound ignores the edges left out
+        total.interrupted = true;
+        total.bound = matchingDualBound(G, S, out.prices);
+    }
+    STATS_DO(total.stats = res.stats;)
+    return total;
+}
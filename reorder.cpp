@@ -0,0 +1,178 @@
+#include "include/reorder.h"
+#include <algorithm>
+#include <cstring>
+#include <queue>
+using namespace std;
+
+bool parseReorderMethod(const char* name, ReorderMethod& method) {
+    if (strcmp(name, "none") == 0)
+        method = REORDER_NONE;
+    else if (strcmp(name, "degree") == 0)
+        method = REORDER_DEGREE;
+    else if (strcmp(name, "rcm") == 0)
+        method = REORDER_RCM;
+    else
+        return false;
+    return true;
+}
+
+// Degrees counted over the left-side rows, so right vertices get their
+// degree even when the input only stored the (i,j) direction.
+static vector<int> bipartiteDegrees(CSR* G) {
+    vector<int> deg(G->nVer, 0);
+    for (int i = 0; i < G->lVer; i++) {
+        deg[i] = G->verPtr[i+1] - G->verPtr[i];
+        for (int j = G->verPtr[i]; j < G->verPtr[i+1]; j++) {
+            deg[G->verInd[j].id]++;
+        }
+    }
+    return deg;
+}
+
+static vector<int> degreeOrder(CSR* G, const vector<int>& deg) {
+    vector<int> newToOld(G->nVer);
+    for (int i = 0; i < G->nVer; i++) {
+        newToOld[i] = i;
+    }
+    auto by_degree = [&deg](int u, int v) { return deg[u] > deg[v]; };
+    stable_sort(newToOld.begin(), newToOld.begin() + G->lVer, by_degree);
+    stable_sort(newToOld.begin() + G->lVer, newToOld.end(), by_degree);
+    return newToOld;
+}
+
+// Breadth-first traversal seeded from low-degree vertices, visiting
+// neighbors by increasing degree, then reversed. Left and right vertices
+// keep their relative visiting order, which places the objects a bidder
+// scans next to each other. The traversal walks from objects back to
+// bidders, so a one-sided graph gets a transpose of its left-side rows
+// here, leaving G as it was.
+static vector<int> rcmOrder(CSR* G, const vector<int>& deg) {
+    int* rowPtr = G->verPtr;
+    Edge* rowInd = G->verInd;
+    vector<int> tPtr;
+    vector<Edge> tInd;
+    if (G->oneSided) {
+        int nLeft = G->verPtr[G->lVer];
+        tPtr.assign(G->nVer + 1, 0);
+        for (int v = 0; v < G->nVer; v++) {
+            tPtr[v+1] = tPtr[v] + (v < G->lVer ? G->verPtr[v+1] - G->verPtr[v] : deg[v]);
+        }
+        tInd.resize(tPtr[G->nVer]);
+        copy(G->verInd, G->verInd + nLeft, tInd.begin());
+        vector<int> fill(tPtr.begin() + G->lVer, tPtr.end() - 1);
+        // Scanning the left rows in order leaves every right row sorted by id
+        for (int i = 0; i < G->lVer; i++) {
+            for (int j = G->verPtr[i]; j < G->verPtr[i+1]; j++) {
+                tInd[fill[G->verInd[j].id - G->lVer]++] = Edge(i, G->verInd[j].weight);
+            }
+        }
+        rowPtr = tPtr.data();
+        rowInd = tInd.data();
+    }
+
+    vector<int> seeds(G->nVer);
+    for (int i = 0; i < G->nVer; i++) {
+        seeds[i] = i;
+    }
+    stable_sort(seeds.begin(), seeds.end(), [&deg](int u, int v) { return deg[u] < deg[v]; });
+
+    vector<bool> visited(G->nVer, false);
+    vector<int> order;
+    order.reserve(G->nVer);
+    vector<int> nbrs;
+    for (int s : seeds) {
+        if (visited[s])
+            continue;
+        visited[s] = true;
+        size_t head = order.size();
+        order.push_back(s);
+        while (head < order.size()) {
+            int u = order[head++];
+            nbrs.clear();
+            for (int j = rowPtr[u]; j < rowPtr[u+1]; j++) {
+                int v = rowInd[j].id;
+                if (!visited[v]) {
+                    visited[v] = true;
+                    nbrs.push_back(v);
+                }
+            }
+            sort(nbrs.begin(), nbrs.end(), [&deg](int a, int b) { return deg[a] < deg[b]; });
+            order.insert(order.end(), nbrs.begin(), nbrs.end());
+        }
+    }
+    reverse(order.begin(), order.end());
+
+    vector<int> newToOld;
+    newToOld.reserve(G->nVer);
+    for (int v : order) {
+        if (v < G->lVer)
+            newToOld.push_back(v);
+    }
+    for (int v : order) {
+        if (v >= G->lVer)
+            newToOld.push_back(v);
+    }
+    return newToOld;
+}
+
+vector<int> reorderPermutation(CSR* G, ReorderMethod method) {
+    if (method == REORDER_NONE) {
+        vector<int> newToOld(G->nVer);
+        for (int i = 0; i < G->nVer; i++) {
+            newToOld[i] = i;
+        }
+        return newToOld;
+    }
+
+    vector<int> deg = bipartiteDegrees(G);
+    if (method == REORDER_DEGREE)
+        return degreeOrder(G, deg);
+    return rcmOrder(G, deg);
+}
+
+void permuteCSR(CSR* G, const vector<int>& newToOld) {
+    vector<int> oldToNew(G->nVer);
+    for (int v = 0; v < G->nVer; v++) {
+        oldToNew[newToOld[v]] = v;
+    }
+
+    int* verPtr = new int[G->nVer+1];
+    Edge* verInd = new Edge[G->nEdge];
+    verPtr[0] = 0;
+    for (int v = 0; v < G->nVer; v++) {
+        int u = newToOld[v];
+        verPtr[v+1] = verPtr[v] + (G->verPtr[u+1] - G->verPtr[u]);
+    }
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int v = 0; v < G->nVer; v++) {
+        int u = newToOld[v];
+        int k = verPtr[v];
+        for (int j = G->verPtr[u]; j < G->verPtr[u+1]; j++) {
+            verInd[k++] = Edge(oldToNew[G->verInd[j].id], G->verInd[j].weight);
+        }
+        sort(verInd + verPtr[v], verInd + verPtr[v+1], [](const Edge& a, const Edge& b) { return a.id < b.id; });
+    }
+
+    int* origId = new int[G->nVer];
+    for (int v = 0; v < G->nVer; v++) {
+        origId[v] = (G->origId != NULL) ? G->origId[newToOld[v]] : newToOld[v];
+    }
+
+    G->dropPacked();
+    delete [] G->verPtr;
+    delete [] G->verInd;
+    if (G->origId != NULL)
+        delete [] G->origId;
+    G->verPtr = verPtr;
+    G->verInd = verInd;
+    G->origId = origId;
+    G->weightSorted = false;
+}
+
+void permuteNodes(Node* S, int n, const vector<int>& newToOld) {
+    vector<Node> tmp(S, S + n);
+    for (int v = 0; v < n; v++) {
+        S[v] = tmp[newToOld[v]];
+    }
+}
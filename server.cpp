@@ -0,0 +1,256 @@
+#include "include/server.h"
+#include "include/output.h"
+#include "include/batch.h"
+#include "include/arena.h"
+#include <atomic>
+#include <algorithm>
+#include <condition_variable>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <set>
+#include <thread>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+using namespace std;
+
+const char solveRequestMagic[4] = {'B', 'M', 'R', 'Q'};
+const char solveResponseMagic[4] = {'B', 'M', 'R', 'S'};
+
+static_assert(sizeof(SolveRequest) == 32 && sizeof(SolveResponse) == 40, "protocol structs must not be padded");
+
+static atomic<bool> stopRequested(false);
+
+static void onStopSignal(int) {
+    stopRequested.store(true);
+}
+
+static bool readFull(int fd, void* buf, size_t n) {
+    char* p = (char*) buf;
+    while (n > 0) {
+        ssize_t r = read(fd, p, n);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            return false;
+        p += r;
+        n -= r;
+    }
+    return true;
+}
+
+static bool writeFull(int fd, const void* buf, size_t n) {
+    const char* p = (const char*) buf;
+    while (n > 0) {
+        ssize_t r = send(fd, p, n, MSG_NOSIGNAL);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            return false;
+        p += r;
+        n -= r;
+    }
+    return true;
+}
+
+// State shared by the accepting thread and the pool
+struct Server {
+    const vector<CSR*>& graphs;
+    const AuctionOptions& aopts;
+    const ServerSolver& solve;
+    int solveThreads;           // OpenMP threads per solve
+
+    mutex lock;
+    condition_variable wake;
+    deque<int> pending;         // Accepted connections waiting for a thread
+    set<int> active;            // Connections being served
+    bool stopping;
+    vector<double> latencies;   // Seconds from request to response, guarded by lock
+
+    Server(const vector<CSR*>& graphs, const AuctionOptions& aopts, const ServerSolver& solve, int solveThreads)
+        : graphs(graphs), aopts(aopts), solve(solve), solveThreads(solveThreads), stopping(false) { }
+
+    void work();
+    void serve(int fd, Arena& arena);
+    int handle(const SolveRequest& req, const vector<int>& b, Arena& arena, AuctionOutput& out, SolveResponse& res);
+};
+
+void Server::work() {
+    omp_set_num_threads(solveThreads);
+    Arena arena;
+    while (true) {
+        int fd;
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [this]() { return stopping || !pending.empty(); });
+            if (stopping)
+                return;
+            fd = pending.front();
+            pending.pop_front();
+            active.insert(fd);
+        }
+        serve(fd, arena);
+        {
+            lock_guard<mutex> guard(lock);
+            active.erase(fd);
+        }
+        close(fd);
+    }
+}
+
+// Answers the requests of one connection until the client closes it
+void Server::serve(int fd, Arena& arena) {
+    SolveRequest req;
+    vector<int> b;
+    vector<char> body;
+    while (readFull(fd, &req, sizeof(SolveRequest))) {
+        double start = omp_get_wtime();
+        if (memcmp(req.magic, solveRequestMagic, sizeof(req.magic)) != 0)
+            return;
+
+        SolveResponse res;
+        memset(&res, 0, sizeof(SolveResponse));
+        memcpy(res.magic, solveResponseMagic, sizeof(res.magic));
+        if (req.graph < 0 || req.graph >= graphs.size() || req.numBValues != graphs[req.graph]->nVer) {
+            res.status = SERVER_ERR_REQUEST;
+            writeFull(fd, &res, sizeof(SolveResponse));
+            return;
+        }
+        b.resize(req.numBValues);
+        if (!readFull(fd, b.data(), b.size() * sizeof(int32_t)))
+            return;
+
+        AuctionOutput out;
+        res.status = handle(req, b, arena, out, res);
+        bool ok = writeFull(fd, &res, sizeof(SolveResponse));
+        if (ok && res.status >= SERVER_OK && (req.flags & SOLVE_MATCHING)) {
+            CSR* G = graphs[req.graph];
+            body.resize(out.matching.size() * sizeof(MatchingRecord) + G->rVer * sizeof(float));
+            MatchingRecord* rec = (MatchingRecord*) body.data();
+            fillMatching(G, out, rec, (float*) (rec + out.matching.size()));
+            ok = writeFull(fd, body.data(), body.size());
+        }
+        if (!ok)
+            return;
+
+        double latency = omp_get_wtime() - start;
+        lock_guard<mutex> guard(lock);
+        latencies.push_back(latency);
+    }
+}
+
+int Server::handle(const SolveRequest& req, const vector<int>& b, Arena& arena, AuctionOutput& out, SolveResponse& res) {
+    if ((req.algorithm != 0 && req.algorithm != 1) || !(req.epsilon > 0))
+        return SERVER_ERR_REQUEST;
+    for (int v : b) {
+        if (v < 0)
+            return SERVER_ERR_REQUEST;
+    }
+
+    CSR* G = graphs[req.graph];
+    try {
+        vector<Node> S;
+        scenarioNodes(G, b, S);
+        AuctionOptions opts = aopts;
+        opts.arena = &arena;
+        opts.out = (req.flags & SOLVE_MATCHING) ? &out : NULL;
+        AlgResult r = solve(G, S.data(), req.algorithm, req.epsilon, opts);
+        if (r.infeasible && !r.fallback)
+            return SERVER_ERR_INFEASIBLE;
+        res.weight = r.weight;
+        res.solveTime = r.total_time;
+        res.numMatched = out.matching.size();
+        res.numObjects = G->rVer;
+        return r.fallback ? SERVER_FALLBACK : SERVER_OK;
+    }
+    catch (const bad_alloc&) {
+        return SERVER_ERR_INTERNAL;
+    }
+}
+
+static double percentile(const vector<double>& sorted, double p) {
+    return sorted[min(sorted.size() - 1, (size_t) (p * sorted.size()))];
+}
+
+bool runServer(const char* path, const vector<CSR*>& graphs, int threads, const AuctionOptions& aopts, const ServerSolver& solve) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(sockaddr_un));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        cerr << "Error: socket path " << path << " is too long" << endl;
+        return false;
+    }
+    strcpy(addr.sun_path, path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path);
+    if (listener < 0 || bind(listener, (sockaddr*) &addr, sizeof(sockaddr_un)) != 0 || listen(listener, 128) != 0) {
+        cerr << "Error: can't listen on " << path << ": " << strerror(errno) << endl;
+        if (listener >= 0)
+            close(listener);
+        return false;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onStopSignal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    Server server(graphs, aopts, solve, max(1, omp_get_max_threads() / threads));
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back(&Server::work, &server);
+    }
+    cout << "Listening on " << path << " with " << threads << " threads, "
+         << server.solveThreads << " per solve" << endl << endl;
+
+    double start = omp_get_wtime();
+    pollfd pfd = {listener, POLLIN, 0};
+    while (!stopRequested.load()) {
+        if (poll(&pfd, 1, 200) <= 0)
+            continue;
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0)
+            continue;
+        lock_guard<mutex> guard(server.lock);
+        server.pending.push_back(fd);
+        server.wake.notify_one();
+    }
+    double elapsed = omp_get_wtime() - start;
+
+    // Drop waiting connections and unblock the threads reading from idle ones
+    {
+        lock_guard<mutex> guard(server.lock);
+        server.stopping = true;
+        for (int fd : server.pending) {
+            close(fd);
+        }
+        server.pending.clear();
+        for (int fd : server.active) {
+            shutdown(fd, SHUT_RDWR);
+        }
+        server.wake.notify_all();
+    }
+    for (thread& t : pool) {
+        t.join();
+    }
+    close(listener);
+    unlink(path);
+
+    vector<double>& lat = server.latencies;
+    sort(lat.begin(), lat.end());
+    cout << "Requests: " << lat.size() << endl;
+    cout << "Throughput: " << lat.size() / elapsed << " requests/s" << endl;
+    if (!lat.empty()) {
+        cout << "Latency p50: " << percentile(lat, 0.5) << ", p99: " << percentile(lat, 0.99)
+             << ", max: " << lat.back() << endl;
+    }
+    cout << endl;
+    return true;
+}
@@ -0,0 +1,380 @@
+#include "include/shard.h"
+#include "include/numa.h"
+#include "include/bidding.h"
+#include <atomic>
+#include <algorithm>
+#include <cerrno>
+#include <cfloat>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+using namespace std;
+
+static_assert(atomic<float>::is_always_lock_free && atomic<int>::is_always_lock_free && atomic<long>::is_always_lock_free,
+              "shared memory atomics must be lock free");
+
+struct SharedCopy {
+    float price;
+    float weight;           // Weight of the edge to the bidder holding the copy
+    atomic<int> bidder;     // -1 while unsold
+};
+
+// Auction state shared by all workers. The arrays point into one
+// MAP_SHARED segment created before the workers are forked.
+struct SharedState {
+    SharedCopy* copies;
+    long* copyPtr;          // Copies of object o are copies[copyPtr[o] .. copyPtr[o+1])
+    atomic<int>* locks;     // Spin lock per object
+    atomic<float>* minPrice;    // Lowest copy price per object, read without the lock
+    atomic<char>* dirty;    // Bidder lost a copy and must bid again
+    atomic<char>* permanent;    // Bidder is not requeued when it loses a copy
+    atomic<long>* mail;     // Per worker, bumped whenever one of its bidders is flagged
+    atomic<long>* work;     // Bidders queued or being processed by any worker
+
+    void* base;
+    size_t bytes;
+};
+
+static size_t align64(size_t n) {
+    return (n + 63) & ~(size_t) 63;
+}
+
+static bool createSharedState(CSR* G, Node* S, int nWorkers, SharedState& st) {
+    long nCopies = 0;
+    for (int i = G->lVer; i < G->nVer; i++) {
+        nCopies += S[i].b;
+    }
+
+    size_t sizes[8] = {
+        nCopies * sizeof(SharedCopy),
+        (G->rVer + 1) * sizeof(long),
+        G->rVer * sizeof(atomic<int>),
+        G->rVer * sizeof(atomic<float>),
+        G->lVer * sizeof(atomic<char>),
+        G->lVer * sizeof(atomic<char>),
+        nWorkers * sizeof(atomic<long>),
+        sizeof(atomic<long>)
+    };
+    size_t offsets[8];
+    st.bytes = 0;
+    for (int k = 0; k < 8; k++) {
+        offsets[k] = st.bytes;
+        st.bytes += align64(sizes[k]);
+    }
+    st.base = mmap(NULL, st.bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (st.base == MAP_FAILED)
+        return false;
+
+    char* base = (char*) st.base;
+    st.copies = (SharedCopy*) (base + offsets[0]);
+    st.copyPtr = (long*) (base + offsets[1]);
+    st.locks = (atomic<int>*) (base + offsets[2]);
+    st.minPrice = (atomic<float>*) (base + offsets[3]);
+    st.dirty = (atomic<char>*) (base + offsets[4]);
+    st.permanent = (atomic<char>*) (base + offsets[5]);
+    st.mail = (atomic<long>*) (base + offsets[6]);
+    st.work = (atomic<long>*) (base + offsets[7]);
+
+    st.copyPtr[0] = 0;
+    for (int o = 0; o < G->rVer; o++) {
+        st.copyPtr[o+1] = st.copyPtr[o] + S[G->lVer + o].b;
+        new (&st.locks[o]) atomic<int>(0);
+        new (&st.minPrice[o]) atomic<float>(0);
+    }
+    for (long c = 0; c < nCopies; c++) {
+        st.copies[c].price = 0;
+        st.copies[c].weight = 0;
+        new (&st.copies[c].bidder) atomic<int>(-1);
+    }
+    for (int i = 0; i < G->lVer; i++) {
+        new (&st.dirty[i]) atomic<char>(0);
+        new (&st.permanent[i]) atomic<char>(0);
+    }
+    for (int w = 0; w < nWorkers; w++) {
+        new (&st.mail[w]) atomic<long>(0);
+    }
+    new (st.work) atomic<long>(G->lVer);
+    return true;
+}
+
+static void lockObject(SharedState& st, int o) {
+    while (st.locks[o].exchange(1, memory_order_acquire)) {
+        while (st.locks[o].load(memory_order_relaxed))
+            sched_yield();
+    }
+}
+
+static void unlockObject(SharedState& st, int o) {
+    st.locks[o].store(0, memory_order_release);
+}
+
+// Lowest priced copy of o; the object lock must be held
+static long cheapestCopy(SharedState& st, int o) {
+    long best = st.copyPtr[o];
+    for (long c = best + 1; c < st.copyPtr[o+1]; c++) {
+        if (st.copies[c].price < st.copies[best].price)
+            best = c;
+    }
+    return best;
+}
+
+static void updateMinPrice(SharedState& st, int o) {
+    st.minPrice[o].store(st.copies[cheapestCopy(st, o)].price, memory_order_relaxed);
+}
+
+// Local state of one worker process
+struct ShardWorker {
+    CSR* G;
+    Node* S;
+    double epsilon;
+    SharedState& st;
+    int id;
+    int lo, hi;                         // Block of bidders owned by this worker
+    const vector<int>& blocks;
+    vector<vector<pair<int, long>>> held;   // (object, copy) pairs believed held, per bidder - lo
+    vector<char> happy;
+    vector<pair<float, Edge>> best;
+
+    ShardWorker(CSR* G, Node* S, double epsilon, SharedState& st, int id, const vector<int>& blocks)
+        : G(G), S(S), epsilon(epsilon), st(st), id(id), lo(blocks[id]), hi(blocks[id+1]), blocks(blocks),
+          held(hi - lo), happy(hi - lo, 0) { }
+
+    int ownerOf(int bidder) {
+        return upper_bound(blocks.begin(), blocks.end(), bidder) - blocks.begin() - 1;
+    }
+
+    bool holds(int bidder, int o) {
+        for (auto& h : held[bidder - lo]) {
+            if (h.first == o)
+                return true;
+        }
+        return false;
+    }
+
+    // Flags a bidder of any worker that lost a copy
+    void evict(int bidder) {
+        if (st.permanent[bidder].load(memory_order_relaxed))
+            return;
+        if (st.dirty[bidder].exchange(1) == 0) {
+            st.work->fetch_add(1);
+            st.mail[ownerOf(bidder)].fetch_add(1);
+        }
+    }
+
+    // One bidding step of bidder, as in bMatchingAuction. Returns false if
+    // some bid lost a race and the bidder has to bid again.
+    bool bid(int bidder) {
+        vector<pair<int, long>>& h = held[bidder - lo];
+        h.erase(remove_if(h.begin(), h.end(), [&](const pair<int, long>& x) {
+            return st.copies[x.second].bidder.load(memory_order_acquire) != bidder;
+        }), h.end());
+
+        // The b+1-|held| most valuable objects worth at least epsilon
+        int k = S[bidder].b + 1 - h.size();
+        bestObjects(G, bidder, k, epsilon, [&](Edge e, float& value) {
+            int o = e.id - G->lVer;
+            if (st.copyPtr[o] == st.copyPtr[o+1] || holds(bidder, o))
+                return false;
+            value = e.weight - st.minPrice[o].load(memory_order_relaxed);
+            return true;
+        }, best);
+
+        bool permanent = false;
+        float comparison = takeComparison(best, k, epsilon, permanent).first;
+        if (permanent)
+            st.permanent[bidder].store(1, memory_order_relaxed);
+
+        bool complete = true;
+        for (auto it = h.begin(); it != h.end(); ) {
+            int o = it->first;
+            SharedCopy& c = st.copies[it->second];
+            lockObject(st, o);
+            bool mine = c.bidder.load(memory_order_relaxed) == bidder;
+            if (mine) {
+                c.price += bidIncrement(c.weight - c.price, comparison, epsilon);
+                updateMinPrice(st, o);
+            }
+            unlockObject(st, o);
+            if (mine) {
+                it++;
+            }
+            else {
+                it = h.erase(it);
+                complete = false;
+            }
+        }
+
+        for (auto& obj : best) {
+            int o = obj.second.id - G->lVer;
+            // The price scanned plus the raise; lost if a concurrent bid
+            // got the cheapest copy there first
+            float price = (obj.second.weight - obj.first) + bidIncrement(obj.first, comparison, epsilon);
+            lockObject(st, o);
+            long ci = cheapestCopy(st, o);
+            SharedCopy& c = st.copies[ci];
+            int old_bidder = -1;
+            bool won = c.price < price;
+            if (won) {
+                old_bidder = c.bidder.load(memory_order_relaxed);
+                c.price = price;
+                c.weight = obj.second.weight;
+                c.bidder.store(bidder, memory_order_release);
+                updateMinPrice(st, o);
+            }
+            unlockObject(st, o);
+
+            if (won) {
+                h.push_back(make_pair(o, ci));
+                if (old_bidder >= 0)
+                    evict(old_bidder);
+            }
+            else {
+                complete = false;
+            }
+        }
+        return complete;
+    }
+
+    void run(SchedulePolicy policy) {
+        BidderScheduler I(policy, G->lVer);
+        for (int i = lo; i < hi; i++) {
+            I.push(i, S[i].b);
+        }
+
+        long seen = 0;
+        while (true) {
+            if (I.empty()) {
+                if (st.work->load() == 0)
+                    break;
+                long m = st.mail[id].load();
+                if (m == seen) {
+                    sched_yield();
+                    continue;
+                }
+                seen = m;
+                for (int i = lo; i < hi; i++) {
+                    if (st.dirty[i].load(memory_order_relaxed) && st.dirty[i].exchange(0)) {
+                        happy[i - lo] = 0;
+                        if (!I.push(i, S[i].b - (int) held[i - lo].size()))
+                            st.work->fetch_sub(1);
+                    }
+                }
+                continue;
+            }
+
+            int bidder = I.pop();
+            if (!happy[bidder - lo]) {
+                if (bid(bidder)) {
+                    happy[bidder - lo] = 1;
+                }
+                else {
+                    I.push(bidder, S[bidder].b - (int) held[bidder - lo].size());
+                    continue;   // Still counted in work
+                }
+            }
+            st.work->fetch_sub(1);
+        }
+    }
+};
+
+AlgResult shardedAuction(CSR* G, Node* S, double epsilon, int nWorkers, const AuctionOptions& aopts) {
+    double start = omp_get_wtime();
+    if (aopts.prof) aopts.prof->begin("Auction Init");
+
+    nWorkers = max(1, min(nWorkers, G->lVer));
+    SharedState st;
+    if (!createSharedState(G, S, nWorkers, st)) {
+        cout << "Warning: could not create the shared segment, running the serial auction" << endl;
+        if (aopts.prof) aopts.prof->end();
+        return bMatchingAuction(G, S, epsilon, false, aopts);
+    }
+    vector<int> blocks = numaBlocks(G, nWorkers);
+
+    double time_init = omp_get_wtime();
+    if (aopts.prof) {
+        aopts.prof->end();
+        aopts.prof->begin("Bidding");
+    }
+
+    cout.flush();
+    vector<pid_t> pids;
+    for (int w = 0; w < nWorkers; w++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            ShardWorker worker(G, S, epsilon, st, w, blocks);
+            worker.run(aopts.schedule);
+            _exit(0);
+        }
+        if (pid < 0)
+            break;
+        pids.push_back(pid);
+    }
+
+    // The other workers can't finish without a missing or failed one, so
+    // they are killed as soon as one is, and the serial auction takes over
+    bool ok = pids.size() == nWorkers;
+    if (!ok) {
+        for (pid_t pid : pids) {
+            kill(pid, SIGKILL);
+        }
+    }
+    for (size_t left = pids.size(); left > 0; ) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR)
+                continue;
+            ok = false;     // Reaped elsewhere, the exit status is lost
+            break;
+        }
+        if (find(pids.begin(), pids.end(), pid) == pids.end())
+            continue;
+        left--;
+        if (ok && !(WIFEXITED(status) && WEXITSTATUS(status) == 0)) {
+            ok = false;
+            for (pid_t other : pids) {
+                kill(other, SIGKILL);
+            }
+        }
+    }
+    if (!ok) {
+        munmap(st.base, st.bytes);
+        cout << "Warning: a shard worker failed, running the serial auction" << endl;
+        if (aopts.prof) aopts.prof->end();
+        return bMatchingAuction(G, S, epsilon, false, aopts);
+    }
+
+    double end = omp_get_wtime();
+    if (aopts.prof) {
+        aopts.prof->end();
+        aopts.prof->begin("Weight Sum");
+    }
+
+    double weight = 0;
+    long nCopies = st.copyPtr[G->rVer];
+    for (long c = 0; c < nCopies; c++) {
+        if (st.copies[c].bidder.load() >= 0)
+            weight += st.copies[c].weight;
+    }
+    if (aopts.prof) aopts.prof->end();
+
+    if (aopts.out) {
+        AuctionOutput& out = *aopts.out;
+        out.matching.clear();
+        out.prices.assign(G->rVer, FLT_MAX);
+        for (int o = 0; o < G->rVer; o++) {
+            if (st.copyPtr[o] < st.copyPtr[o+1])
+                out.prices[o] = st.minPrice[o].load();
+            for (long c = st.copyPtr[o]; c < st.copyPtr[o+1]; c++) {
+                SharedCopy& sc = st.copies[c];
+                if (sc.bidder.load() >= 0)
+                    out.matching.push_back(MatchedEdge(sc.bidder.load(), G->lVer + o, sc.weight, sc.price));
+            }
+        }
+    }
+
+    munmap(st.base, st.bytes);
+    return AlgResult(end - start, time_init - start, weight);
+}
@@ -0,0 +1,261 @@
+#include "include/stream.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+using namespace std;
+
+static const size_t chunkSize = 1 << 20;
+
+// Turns the raw bytes of a file into input data. decode() runs on the
+// producer thread and returns the number of bytes written to out, 0 at the
+// end of the data and -1 on an error.
+class Decoder {
+    public:
+    Decoder(int fd) : fd(fd), in(chunkSize), pos(0), end(0), eof(false) { }
+    virtual ~Decoder() { }
+    virtual long decode(char* out, size_t cap) = 0;
+
+    protected:
+    int fd;
+    vector<char> in;            // Raw bytes [pos, end) not consumed yet
+    size_t pos, end;
+    bool eof;
+
+    // Reads more raw bytes once the buffer is consumed. Returns false at
+    // the end of the file or on an error.
+    bool fill() {
+        if (pos < end)
+            return true;
+        pos = end = 0;
+        while (!eof) {
+            ssize_t n = ::read(fd, in.data(), in.size());
+            if (n > 0) {
+                end = n;
+                return true;
+            }
+            if (n < 0 && errno == EINTR)
+                continue;
+            eof = true;
+            if (n < 0)
+                return false;
+        }
+        return false;
+    }
+
+    friend ByteStream* ByteStream::open(const char* filename);
+};
+
+class PlainDecoder : public Decoder {
+    public:
+    PlainDecoder(int fd) : Decoder(fd) { }
+
+    long decode(char* out, size_t cap) {
+        if (!fill())
+            return 0;
+        size_t n = min(cap, end - pos);
+        memcpy(out, in.data() + pos, n);
+        pos += n;
+        return n;
+    }
+};
+
+class GzipDecoder : public Decoder {
+    public:
+    GzipDecoder(int fd) : Decoder(fd), finished(false) {
+        memset(&zs, 0, sizeof(zs));
+        ok = inflateInit2(&zs, 16 + MAX_WBITS) == Z_OK;
+    }
+    ~GzipDecoder() { inflateEnd(&zs); }
+
+    long decode(char* out, size_t cap) {
+        if (!ok)
+            return -1;
+        zs.next_out = (Bytef*) out;
+        zs.avail_out = cap;
+        while (zs.avail_out == cap) {
+            if (finished) {
+                // A new member may follow the end of the previous one
+                if (!fill())
+                    return 0;
+                inflateReset(&zs);
+                finished = false;
+            }
+            if (pos == end && !fill())
+                return -1;      // Truncated
+            zs.next_in = (Bytef*) in.data() + pos;
+            zs.avail_in = end - pos;
+            int ret = inflate(&zs, Z_NO_FLUSH);
+            pos = end - zs.avail_in;
+            if (ret == Z_STREAM_END)
+                finished = true;
+            else if (ret != Z_OK && ret != Z_BUF_ERROR)
+                return -1;
+        }
+        return cap - zs.avail_out;
+    }
+
+    private:
+    z_stream zs;
+    bool ok;
+    bool finished;      // The current member is complete
+};
+
+#ifdef HAVE_ZSTD
+class ZstdDecoder : public Decoder {
+    public:
+    ZstdDecoder(int fd) : Decoder(fd), ds(ZSTD_createDStream()), pending(0) {
+        if (ds != NULL)
+            ZSTD_initDStream(ds);
+    }
+    ~ZstdDecoder() { ZSTD_freeDStream(ds); }
+
+    long decode(char* out, size_t cap) {
+        if (ds == NULL)
+            return -1;
+        ZSTD_outBuffer ob = {out, cap, 0};
+        while (ob.pos == 0) {
+            if (pos == end && !fill())
+                return (pending == 0) ? 0 : -1;     // Truncated if a frame is incomplete
+            ZSTD_inBuffer ib = {in.data(), end, pos};
+            size_t ret = ZSTD_decompressStream(ds, &ob, &ib);
+            if (ZSTD_isError(ret))
+                return -1;
+            pos = ib.pos;
+            pending = ret;
+        }
+        return ob.pos;
+    }
+
+    private:
+    ZSTD_DStream* ds;
+    size_t pending;     // Nonzero while a frame is incomplete
+};
+#endif
+
+ByteStream* ByteStream::open(const char* filename) {
+    bool is_stdin = strcmp(filename, "-") == 0;
+    int fd = is_stdin ? 0 : ::open(filename, O_RDONLY);
+    if (fd < 0) {
+        cerr << "Error: can't open " << filename << endl;
+        return NULL;
+    }
+
+    // Sniff the magic bytes; the decoder starts from the bytes read here, so
+    // this also works on pipes
+    PlainDecoder probe(fd);
+    while (probe.end < 4 && !probe.eof) {
+        ssize_t n = ::read(fd, probe.in.data() + probe.end, probe.in.size() - probe.end);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            probe.eof = true;
+        else
+            probe.end += n;
+    }
+    const unsigned char* m = (const unsigned char*) probe.in.data();
+    size_t n = probe.end;
+    Decoder* decoder;
+    const char* name;
+    if (n >= 2 && m[0] == 0x1f && m[1] == 0x8b) {
+        decoder = new GzipDecoder(fd);
+        name = "gzip";
+    }
+    else if (n >= 4 && m[0] == 0x28 && m[1] == 0xb5 && m[2] == 0x2f && m[3] == 0xfd) {
+#ifdef HAVE_ZSTD
+        decoder = new ZstdDecoder(fd);
+        name = "zstd";
+#else
+        cerr << "Error: " << filename << " is zstd compressed, which needs a build with HAVE_ZSTD" << endl;
+        if (!is_stdin)
+            close(fd);
+        return NULL;
+#endif
+    }
+    else {
+        decoder = new PlainDecoder(fd);
+        name = "plain";
+    }
+    decoder->in.swap(probe.in);
+    decoder->pos = 0;
+    decoder->end = probe.end;
+    decoder->eof = probe.eof;
+    return new ByteStream(is_stdin ? -1 : fd, decoder, name);
+}
+
+ByteStream::ByteStream(int fd, Decoder* decoder, const char* formatName)
+    : fd(fd), decoder(decoder), formatName(formatName), head(0), tail(0), filled(0), offset(0),
+      done(false), stopping(false), error(false) {
+    for (Chunk& c : chunks) {
+        c.data.resize(chunkSize);
+    }
+    producer = thread(&ByteStream::produce, this);
+}
+
+ByteStream::~ByteStream() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+        changed.notify_all();
+    }
+    producer.join();
+    delete decoder;
+    if (fd >= 0)
+        close(fd);
+}
+
+void ByteStream::produce() {
+    while (true) {
+        {
+            unique_lock<mutex> guard(lock);
+            changed.wait(guard, [this]() { return stopping || filled < 4; });
+            if (stopping)
+                return;
+        }
+        Chunk& c = chunks[head];
+        long n = decoder->decode(c.data.data(), c.data.size());
+        lock_guard<mutex> guard(lock);
+        if (n <= 0) {
+            error.store(n < 0);
+            done = true;
+            changed.notify_all();
+            return;
+        }
+        c.len = n;
+        head = (head + 1) % 4;
+        filled++;
+        changed.notify_all();
+    }
+}
+
+size_t ByteStream::read(char* dst, size_t cap) {
+    size_t copied = 0;
+    while (copied < cap) {
+        Chunk* c;
+        {
+            unique_lock<mutex> guard(lock);
+            changed.wait(guard, [this]() { return filled > 0 || done; });
+            if (filled == 0)
+                break;
+            c = &chunks[tail];
+        }
+        // The producer leaves queued chunks alone
+        size_t n = min(cap - copied, c->len - offset);
+        memcpy(dst + copied, c->data.data() + offset, n);
+        copied += n;
+        offset += n;
+        if (offset == c->len) {
+            lock_guard<mutex> guard(lock);
+            offset = 0;
+            tail = (tail + 1) % 4;
+            filled--;
+            changed.notify_all();
+        }
+    }
+    return copied;
+}
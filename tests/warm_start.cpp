@@ -0,0 +1,79 @@
+// A b-matching auction warm started from the prices of a cold solve of the
+// same graph must finish within a bid budget the cold start can't, with the
+// cold weight up to epsilon per unit of b. Build and run with make test.
+#include "graph.h"
+#include "auction.h"
+#include "bvalues.h"
+#include <iostream>
+#include <random>
+using namespace std;
+
+static const double epsilon = 0.5;
+
+// Random bipartite graph with n vertices a side, m integer weighted edges
+// and b drawn from [1, max_b]
+static void randomGraph(CSR& G, vector<Node>& S, int n, int m, int max_b, unsigned seed) {
+    mt19937 rng(seed);
+    vector<vector<Edge>> rows(n);
+    for (int k = 0; k < m; k++) {
+        rows[rng() % n].push_back(Edge(n + rng() % n, (float)(1 + rng() % 1000)));
+    }
+    G.lVer = G.rVer = n;
+    G.nVer = 2 * n;
+    G.nEdge = m;
+    G.maxWeight = 1000;
+    G.oneSided = true;
+    G.verPtr = new int[G.nVer + 1];
+    G.verInd = new Edge[m];
+    G.verPtr[0] = 0;
+    for (int i = 0, k = 0; i < G.nVer; i++) {
+        if (i < n) {
+            for (Edge e : rows[i]) {
+                G.verInd[k++] = e;
+            }
+        }
+        G.verPtr[i+1] = k;
+    }
+    S.resize(G.nVer);
+    for (int v = 0; v < G.nVer; v++) {
+        S[v].b = 1 + rng() % max_b;
+    }
+    computeDegrees(&G, S.data());
+}
+
+static bool check(const char* name, int max_b, long budget) {
+    CSR G;
+    vector<Node> S;
+    randomGraph(G, S, 3000, 24000, max_b, 7);
+    long total_b = 0;
+    for (int i = 0; i < G.lVer; i++) {
+        total_b += S[i].b;
+    }
+
+    AuctionOutput out;
+    AuctionOptions cold_opts;
+    cold_opts.out = &out;
+    AlgResult cold = bMatchingAuction(&G, S.data(), epsilon, false, cold_opts);
+
+    AuctionOptions limited_opts;
+    limited_opts.bid_budget = budget;
+    AlgResult limited = bMatchingAuction(&G, S.data(), epsilon, false, limited_opts);
+
+    vector<float> prices = out.prices;
+    AuctionOptions warm_opts;
+    warm_opts.warm_prices = &prices;
+    warm_opts.bid_budget = budget;
+    AlgResult warm = bMatchingAuction(&G, S.data(), epsilon, false, warm_opts);
+
+    bool ok = limited.interrupted && !warm.interrupted && fabs(warm.weight - cold.weight) <= total_b * epsilon;
+    cout << (ok ? "PASS " : "FAIL ") << name << ": cold " << cold.weight << ", warm " << warm.weight
+         << (warm.interrupted ? " (interrupted)" : "") << " within " << budget << " rounds"
+         << (limited.interrupted ? "" : ", which the cold start also met") << endl;
+    return ok;
+}
+
+int main() {
+    bool ok = check("b = 1", 1, 300);
+    ok = check("b in [1, 4]", 4, 3000) && ok;
+    return ok ? 0 : 1;
+}